@@ -0,0 +1,193 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+	A smooth 2D vector field sampled on a coarse grid of pixels & interpolated bicubically (Catmull-Rom).
+
+	Used for fields that change slowly over the image (eg. a low frequency domain warp), so they can be
+	evaluated once every step pixels rather than at every pixel.
+	Tile (tx, ty) covers pixels [tx * step, (tx + 1) * step) and is interpolated from the 4x4 grid points
+	around it.  Each tile is checked against the exact field at 9 points (corners, edge midpoints & centre),
+	and tiles with too large an error are marked invalid, so the caller evaluates them exactly.
+	(eg. near the kinks of Abs(x,y))
+
+********************************************************************************************************/
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "simd-concepts.h"
+#include "linear-algebra.h"
+
+
+/**************************************************************************************************
+Catmull-Rom weights of 4 evenly spaced points, for t (0..1) between points 1 & 2.
+*************************************************************************************************/
+template <SimdFloat S>
+inline std::array<S, 4> catmull_rom_weights(const S& t) {
+	using T = typename S::F;
+	const S t2 = t * t;
+	const S t3 = t2 * t;
+	return {
+		(t2 + t2 - t - t3) * static_cast<T>(0.5),
+		(t3 * static_cast<T>(3.0) - t2 * static_cast<T>(5.0) + static_cast<T>(2.0)) * static_cast<T>(0.5),
+		(t2 * static_cast<T>(4.0) + t - t3 * static_cast<T>(3.0)) * static_cast<T>(0.5),
+		(t3 - t2) * static_cast<T>(0.5),
+	};
+}
+
+
+/**************************************************************************************************
+The grid.  Build once per frame, then sample() is thread safe.
+*************************************************************************************************/
+class CoarseGrid {
+	int step{};
+	int tiles_x{};
+	int tiles_y{};
+	int columns{};						//Grid points per row (tiles_x + 3)
+	std::vector<float> field_x{};		//Point (i, j) is the field at pixel ((i - 1) * step, (j - 1) * step)
+	std::vector<float> field_y{};
+	std::vector<uint8_t> tile_valid{};
+
+public:
+	bool empty() const noexcept { return tile_valid.empty(); }
+
+	//Number of tiles that passed the error check.
+	size_t valid_tiles() const noexcept { return static_cast<size_t>(std::count(tile_valid.begin(), tile_valid.end(), uint8_t{ 1 })); }
+
+	/**************************************************************************************************
+	Samples field for an image of width x height pixels.
+	field(px, py) returns the exact field (vec2<S>) at each lane's pixel.
+	max_error is the largest difference (on either axis, in field units) allowed at the checked points of a tile.
+	*************************************************************************************************/
+	template <SimdFloat S, typename Field>
+	void build(int width, int height, int grid_step, double max_error, Field&& field) {
+		using T = typename S::F;
+		constexpr int lanes = S::number_of_elements();
+		step = std::max(grid_step, 1);
+		tiles_x = (std::max(width, 0) + step - 1) / step;
+		tiles_y = (std::max(height, 0) + step - 1) / step;
+		columns = tiles_x + 3;
+		const int rows = tiles_y + 3;
+		field_x.assign(static_cast<size_t>(columns) * rows, 0.0f);
+		field_y.assign(static_cast<size_t>(columns) * rows, 0.0f);
+		tile_valid.assign(static_cast<size_t>(tiles_x) * tiles_y, uint8_t{ 0 });
+		if (tiles_x == 0 || tiles_y == 0) return;
+
+		//Grid points
+		for (int j = 0; j < rows; j++) {
+			const S py(static_cast<T>((j - 1) * step));
+			for (int i = 0; i < columns; i += lanes) {
+				const S px = (S::make_sequential(static_cast<T>(i)) - static_cast<T>(1.0)) * static_cast<T>(step);
+				const vec2<S> v = field(px, py);
+				for (int l = 0; l < lanes && i + l < columns; l++) {
+					field_x[static_cast<size_t>(j) * columns + i + l] = static_cast<float>(v.x.element(l));
+					field_y[static_cast<size_t>(j) * columns + i + l] = static_cast<float>(v.y.element(l));
+				}
+			}
+		}
+
+		//Check each tile against the exact field at its corners, edge midpoints & centre.
+		//(The error peaks between grid points & can be far from the centre, so a single sample misses tiles)
+		const std::array<int, 3> offsets{ 0, step / 2, step - 1 };
+		std::vector<double> tile_error(tile_valid.size(), 0.0);
+		for (int ty = 0; ty < tiles_y; ty++) {
+			for (const int oy : offsets) {
+				const S py(static_cast<T>(ty * step + oy));
+				for (const int ox : offsets) {
+					for (int tx = 0; tx < tiles_x; tx += lanes) {
+						const S px = S::make_sequential(static_cast<T>(tx)) * static_cast<T>(step) + static_cast<T>(ox);
+						const vec2<S> exact = field(px, py);
+						for (int l = 0; l < lanes && tx + l < tiles_x; l++) {
+							const auto approx = interpolate(tx + l, ty, static_cast<double>(ox) / step, static_cast<double>(oy) / step);
+							double& error = tile_error[static_cast<size_t>(ty) * tiles_x + tx + l];
+							error = std::max({ error, std::abs(approx[0] - static_cast<double>(exact.x.element(l))), std::abs(approx[1] - static_cast<double>(exact.y.element(l))) });
+						}
+					}
+				}
+			}
+		}
+		for (size_t i = 0; i < tile_valid.size(); i++) tile_valid[i] = tile_error[i] <= max_error;
+	}
+
+	/**************************************************************************************************
+	Interpolated field at each lane's pixel (px, py).
+	Returns false (and leaves out unchanged) unless every lane is in the same valid tile.
+	(Square pixel packets never straddle tiles when step is a multiple of the packet size)
+	*************************************************************************************************/
+	template <SimdFloat S>
+	bool sample(const S& px, const S& py, vec2<S>& out) const {
+		if (empty()) return false;
+		const S fx = px / static_cast<typename S::F>(step);
+		const S fy = py / static_cast<typename S::F>(step);
+		const S tx = floor(fx);
+		const S ty = floor(fy);
+		if (!is_uniform(tx) || !is_uniform(ty)) return false;
+		const auto ix = static_cast<int>(tx.element(0));
+		const auto iy = static_cast<int>(ty.element(0));
+		if (ix < 0 || iy < 0 || ix >= tiles_x || iy >= tiles_y || !tile_valid[static_cast<size_t>(iy) * tiles_x + ix]) return false;
+
+		const auto wx = catmull_rom_weights(fx - tx);
+		const auto wy = catmull_rom_weights(fy - ty);
+		S x(0.0);
+		S y(0.0);
+		for (int j = 0; j < 4; j++) {
+			S row_x(0.0);
+			S row_y(0.0);
+			const size_t row = static_cast<size_t>(iy + j) * columns + ix;
+			for (int i = 0; i < 4; i++) {
+				row_x = fma(wx[i], S(static_cast<typename S::F>(field_x[row + i])), row_x);
+				row_y = fma(wx[i], S(static_cast<typename S::F>(field_y[row + i])), row_y);
+			}
+			x = fma(wy[j], row_x, x);
+			y = fma(wy[j], row_y, y);
+		}
+		out = vec2<S>(x, y);
+		return true;
+	}
+
+private:
+	//Scalar interpolation within tile (tx, ty), at (u, v) 0..1 across the tile.
+	std::array<double, 2> interpolate(int tx, int ty, double u, double v) const {
+		const auto weights = [](double t) {
+			const double t2 = t * t;
+			const double t3 = t2 * t;
+			return std::array<double, 4>{ (2.0 * t2 - t - t3) * 0.5, (3.0 * t3 - 5.0 * t2 + 2.0) * 0.5, (4.0 * t2 + t - 3.0 * t3) * 0.5, (t3 - t2) * 0.5 };
+		};
+		const auto wx = weights(u);
+		const auto wy = weights(v);
+		std::array<double, 2> r{};
+		for (int j = 0; j < 4; j++) {
+			const size_t row = static_cast<size_t>(ty + j) * columns + tx;
+			for (int i = 0; i < 4; i++) {
+				r[0] += wy[j] * wx[i] * field_x[row + i];
+				r[1] += wy[j] * wx[i] * field_y[row + i];
+			}
+		}
+		return r;
+	}
+};
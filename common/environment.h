@@ -141,6 +141,13 @@ namespace mt::environment {
 	constexpr static bool compiler_has_avx2 = false;
 #endif
 
+//MSVC has no F16C macro, but its AVX2 builds target x86-64-v3, which includes F16C.  (Simd256Float32::cpu_supported checks it)
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+	constexpr static bool compiler_has_f16c = true;
+#else
+	constexpr static bool compiler_has_f16c = false;
+#endif
+
 #if defined(__FMA__)
 	constexpr static bool compiler_has_fma = true;
 #else
@@ -23,43 +23,85 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 Description:
 
-    
+	A common set of input space transforms shared by multiple projects.
 
-Types:
+	The transform is resolved once per frame (build_input_transform_plan) into a function pointer
+	to a kernel specialised for that transform, so each pixel only pays for its own math.
+
+	Translate, scale & rotation are combined into one affine pre-transform (2x3 matrix) in double.
+	Callers can fold it into their own per-frame matrices (pixel normalisation before, scale after),
+	and for "None" the whole transform is a single matrix.
 
+Types:
 
+	InputTransform				- The available transforms (same order as the list parameter).
+	InputTransformPlan<S>		- Per-frame transform constants and the selected kernel.
 
 
 *******************************************************************************************************/
+#pragma once
+
 #include "parameters.h"
 #include "simd-concepts.h"
 #include "linear-algebra.h"
 
+#include <array>
 #include <numbers>
+#include <string>
+
+
+/**************************************************************************************************
+ * Available transforms.
+ * Must match the order of input_transform_names.
+ * ************************************************************************************************/
+enum class InputTransform {
+	none,
+	wave,
+	sqrt_r,
+	abs_xy,
+	sqrt_abs_xy,
+	complex_cosine,
+	complex_cosine_sqrt_r,
+	cartesian_to_polar,
+};
+
+inline constexpr std::array<const char*, 8> input_transform_names{
+	"None",
+	"Wave",
+	"Sqrt(r)",
+	"Abs(x,y)",
+	"Sqrt(Abs(x,y))",
+	"Complex Cosine",
+	"Complex Cosine Sqrt(r)",
+	"Cartesian to Polar",
+};
+
+//Look up a transform by its list name. (Unknown names are treated as "None")
+inline InputTransform input_transform_from_string(const std::string& name) {
+	for (size_t i = 0; i < input_transform_names.size(); i++) {
+		if (name == input_transform_names[i]) return static_cast<InputTransform>(i);
+	}
+	return InputTransform::none;
+}
+
+//Look up a transform by its list index. (The list is input_transform_names, out of range is "None")
+inline InputTransform input_transform_from_index(int index) {
+	return (index >= 0 && index < static_cast<int>(input_transform_names.size())) ? static_cast<InputTransform>(index) : InputTransform::none;
+}
 
 /**************************************************************************************************
  *
  * ************************************************************************************************/
-inline void build_input_transforms_parameter_list(ParameterList& params) {
+inline void build_input_transforms_parameter_list(ParameterDefinitions& params) {
 	params.add_entry(ParameterEntry::make_group_start(ParameterID::input_transform_group_start, "Input Space Transform"));
 
 	params.add_entry(ParameterEntry::make_number(ParameterID::input_transform_translate_x, "Translate x (%)", -100000.0, 100000.0, 0.0, -100.0, 100.0, 2));
 	params.add_entry(ParameterEntry::make_number(ParameterID::input_transform_translate_y, "Translate y(%)", -100000.0, 100000.0, 0.0, -100.0, 100.0, 2));
 	params.add_entry(ParameterEntry::make_number(ParameterID::input_transform_scale,"Scale",0.0,10000.0,1.0,0.0,10.0,2));
+	params.add_entry(ParameterEntry::make_number(ParameterID::input_transform_rotation, "Rotation (degrees)", -100000.0, 100000.0, 0.0, -180.0, 180.0, 2));
 	
 
-	std::vector<std::string> input_list{};
-	input_list.push_back("None");	
-	input_list.push_back("Wave");
-	input_list.push_back("Sqrt(r)");
-	
-	input_list.push_back("Abs(x,y)");
-	input_list.push_back("Sqrt(Abs(x,y))");
-
-	input_list.push_back("Complex Cosine");
-	input_list.push_back("Complex Cosine Sqrt(r)");
-
-	input_list.push_back("Cartesian to Polar");
+	std::vector<std::string> input_list(input_transform_names.begin(), input_transform_names.end());
 	params.add_entry(ParameterEntry::make_list(ParameterID::input_transform_type, "Special Transform", std::move(input_list)));
 
 	params.add_entry(ParameterEntry::make_number(ParameterID::input_transform_special1, "Special Parameter 1", -100000.0, 100000.0, 1.0, -50.0, 50.0, 2));
@@ -74,75 +116,92 @@ inline void build_input_transforms_parameter_list(ParameterList& params) {
 
 
 /**************************************************************************************************
- *
+ * Per-frame input transform constants.
+ * Build with build_input_transform_plan(), then call apply() for each pixel.
  * ************************************************************************************************/
 template <SimdFloat S>
-vec2<S> perform_input_transform(const std::string& transform_name, vec2<S> p, const ParameterList& params) {
-	constexpr typename S::F pi = 3.1415926535897932384626433832795;
-	
-	using namespace std::numbers;
-
-
-
-	//Pre-Transform (don't compute null-ops as they can affect image quality)
-	const auto tx = params.get_value(ParameterID::input_transform_translate_x);
-	if (tx != 0.0) {
-		p.x += static_cast<typename S::F>(tx / 100.0f);
-	}
-	const auto ty = params.get_value(ParameterID::input_transform_translate_y);
-	if (ty != 0.0) {
-		p.y += static_cast<typename S::F>(ty / 100.0f);
+struct InputTransformPlan {
+	typedef vec2<S>(*Kernel)(vec2<S>, const InputTransformPlan&);
+
+	InputTransform transform{};
+	Kernel kernel{};
+
+	affine2<double> pre_transform{};  //Translate, scale & rotation (in that order)
+	affine2<S> pre{};                 //pre_transform for S
+	S special1{};
+	S special2{};
+	bool special1_active{};  //special1 != 1.0
+	bool special2_active{};  //special2 != 1.0
+	bool affine{};           //"None", so the whole transform is pre_transform & apply_special() returns p unchanged
+	bool separable{};        //See column_x()
+
+	//The full transform (pre-transform, then the special transform)
+	vec2<S> apply(vec2<S> p) const { return kernel(pre.apply(p), *this); }
+
+	//The special transform only, for a p that has already been through pre_transform.  (eg. folded into a caller's matrix)
+	vec2<S> apply_special(vec2<S> p) const { return kernel(p, *this); }
+
+	//Separable special transforms ("None", "Wave", "Abs(x,y)" & "Sqrt(Abs(x,y))" with no rotation) one axis at a time, with the same rounding as apply_special():
+	//apply_special(p) == vec2(column_x(p.x), row_y(p.y) + column_y(p.x)) for "Wave", and vec2(column_x(p.x), row_y(p.y)) for the others.
+	//(With no rotation the pre-transformed x only depends on the pixel column, and y on the row)
+	S column_x(S x) const { return separable_axis(x); }
+	S row_y(S y) const { return separable_axis(y); }
+	S column_y(S x) const {
+		constexpr typename S::F pi = 3.1415926535897932384626433832795;
+		return 0.1f * special2 * sin(2.0 * pi * x * special1);
 	}
-	const auto ts = params.get_value(ParameterID::input_transform_scale);
-	if (ts != 1.0 ) {
-		p *= static_cast<typename S::F>(ts);
+
+private:
+	S separable_axis(S v) const {
+		if (transform == InputTransform::abs_xy) return abs(v);
+		if (transform == InputTransform::sqrt_abs_xy) return sqrt(abs(v));
+		return v;
 	}
-	
+};
 
-	const auto special1 = static_cast<typename S::F>(params.get_value(ParameterID::input_transform_special1));
-	const auto special2 = static_cast<typename S::F>(params.get_value(ParameterID::input_transform_special2));
 
-	
-	if (transform_name == "None") return p;
+/**************************************************************************************************
+ * Special transform kernel.  (p has already been pre-transformed)
+ * ************************************************************************************************/
+template <SimdFloat S, InputTransform T>
+vec2<S> input_transform_kernel(vec2<S> p, const InputTransformPlan<S>& plan) {
+	constexpr typename S::F pi = 3.1415926535897932384626433832795;
 
-	if (transform_name == "Wave") {
+	if constexpr (T == InputTransform::wave) {
 		auto x = p.x;
-		auto y = p.y + 0.1f * special2* sin(2.0 * pi * p.x * special1);
+		auto y = p.y + 0.1f * plan.special2 * sin(2.0 * pi * p.x * plan.special1);
 		return vec2{x, y};
 	}
 	
-	
-	if (transform_name == "Abs(x,y)") {
+	if constexpr (T == InputTransform::abs_xy) {
 		return abs(p);
 	}
 
-	if (transform_name == "Sqrt(Abs(x,y))") {
+	if constexpr (T == InputTransform::sqrt_abs_xy) {
 		return sqrt(abs(p));
 	}
 
-	if (transform_name == "Sqrt(r)") {
+	if constexpr (T == InputTransform::sqrt_r) {
 		auto r = p.magnitude();
 		auto theta = atan2(p.y, p.x);
 		r = sqrt(r);
 		auto x = r * cos(theta);
 		auto y = r * sin(theta);
-		
 		return vec2{ x, y };
 	}
 
-
-	if (transform_name == "Complex Cosine") {
+	if constexpr (T == InputTransform::complex_cosine) {
 		p += 0.000001; //Slight offset improves render
 		p *= pi;
-		if (special1 != 1.0) p.x *= special1;
-		if (special2 != 1.0) p.x *= special2;
+		if (plan.special1_active) p.x *= plan.special1;
+		if (plan.special2_active) p.x *= plan.special2;
 
 		auto x = cos(p.x) * cosh(p.y);
 		auto y = -sin(p.x) * sinh(p.y);
 		return vec2{ x, y };
 	}
 
-	if (transform_name == "Complex Cosine Sqrt(r)") {
+	if constexpr (T == InputTransform::complex_cosine_sqrt_r) {
 		p += 0.000001; //Slight offset improves render
 		auto r = p.magnitude();
 		auto theta = atan2(p.y, p.x);
@@ -150,22 +209,80 @@ vec2<S> perform_input_transform(const std::string& transform_name, vec2<S> p, co
 		p.x = r * cos(theta);
 		p.y = r * sin(theta);
 		p *= pi;
-		if (special1 != 1.0) p.x *= special1;
-		if (special2 != 1.0) p.x *= special2;
+		if (plan.special1_active) p.x *= plan.special1;
+		if (plan.special2_active) p.x *= plan.special2;
 		auto x = cos(p.x) * cosh(p.y);
 		auto y = -sin(p.x) * sinh(p.y );
 		return vec2{ x, y };
 	}
 
-
-	if (transform_name == "Cartesian to Polar") {
+	if constexpr (T == InputTransform::cartesian_to_polar) {
 		auto r = p.magnitude();
 		auto theta = atan2(p.y, p.x);
 		return vec2{r,theta };
 	}
 
-
 	return p;
 }
 
 
+/**************************************************************************************************
+ * Read the input transform parameters and select a kernel.
+ * (Call once per frame)
+ * ************************************************************************************************/
+template <SimdFloat S>
+InputTransformPlan<S> build_input_transform_plan(InputTransform transform, const ParameterList& params) {
+	using F = typename S::F;
+	InputTransformPlan<S> plan{};
+
+	plan.transform = transform;
+
+	//Pre-Transform.  (Combined in double, null-ops are left out so they are exact)
+	const auto tx = params.get_value(ParameterID::input_transform_translate_x);
+	const auto ty = params.get_value(ParameterID::input_transform_translate_y);
+	const auto ts = params.get_value(ParameterID::input_transform_scale);
+	const auto rotation = params.get_value(ParameterID::input_transform_rotation);
+	auto pre = affine2<double>::identity();
+	if (tx != 0.0 || ty != 0.0) pre = affine2<double>::translate(tx / 100.0, ty / 100.0) * pre;
+	if (ts != 1.0) pre = affine2<double>::scale(ts, ts) * pre;
+	if (rotation != 0.0) pre = affine2<double>::rotate(rotation * std::numbers::pi / 180.0) * pre;
+	plan.pre_transform = pre;
+	plan.pre = pre.to<S>();
+
+	const auto special1 = static_cast<F>(params.get_value(ParameterID::input_transform_special1));
+	const auto special2 = static_cast<F>(params.get_value(ParameterID::input_transform_special2));
+	plan.special1 = S(special1);
+	plan.special2 = S(special2);
+	plan.special1_active = special1 != 1.0;
+	plan.special2_active = special2 != 1.0;
+
+	plan.affine = transform == InputTransform::none;
+	plan.separable = pre.is_axis_aligned() && (transform == InputTransform::none || transform == InputTransform::wave || transform == InputTransform::abs_xy || transform == InputTransform::sqrt_abs_xy);
+
+	switch (plan.transform) {
+	case InputTransform::none: plan.kernel = &input_transform_kernel<S, InputTransform::none>; break;
+	case InputTransform::wave: plan.kernel = &input_transform_kernel<S, InputTransform::wave>; break;
+	case InputTransform::sqrt_r: plan.kernel = &input_transform_kernel<S, InputTransform::sqrt_r>; break;
+	case InputTransform::abs_xy: plan.kernel = &input_transform_kernel<S, InputTransform::abs_xy>; break;
+	case InputTransform::sqrt_abs_xy: plan.kernel = &input_transform_kernel<S, InputTransform::sqrt_abs_xy>; break;
+	case InputTransform::complex_cosine: plan.kernel = &input_transform_kernel<S, InputTransform::complex_cosine>; break;
+	case InputTransform::complex_cosine_sqrt_r: plan.kernel = &input_transform_kernel<S, InputTransform::complex_cosine_sqrt_r>; break;
+	case InputTransform::cartesian_to_polar: plan.kernel = &input_transform_kernel<S, InputTransform::cartesian_to_polar>; break;
+	}
+	return plan;
+}
+
+template <SimdFloat S>
+InputTransformPlan<S> build_input_transform_plan(const ParameterList& params) {
+	return build_input_transform_plan<S>(input_transform_from_index(params.get_value_integer(ParameterID::input_transform_type)), params);
+}
+
+
+/**************************************************************************************************
+ * Apply a transform by name.
+ * Note: Resolves the transform on every call, prefer building an InputTransformPlan once per frame.
+ * ************************************************************************************************/
+template <SimdFloat S>
+vec2<S> perform_input_transform(const std::string& transform_name, vec2<S> p, const ParameterList& params) {
+	return build_input_transform_plan<S>(input_transform_from_string(transform_name), params).apply(p);
+}
@@ -151,6 +151,57 @@ template <typename F> inline F magnitude(const vec2<F>& a) { return a.magnitude(
 
 
 
+/**************************************************************************************************
+ * A 2D affine transform (2x3 matrix)  p' = (xx * p.x + xy * p.y + x0,  yx * p.x + yy * p.y + y0)
+ * Build & combine in double (once per frame), then convert with to<S>() and apply per pixel.
+ * ************************************************************************************************/
+template <typename F>
+struct affine2 {
+	F xx{}, xy{}, x0{};
+	F yx{}, yy{}, y0{};
+
+	affine2() = default;
+	affine2(F xx1, F xy1, F x01, F yx1, F yy1, F y01) noexcept : xx(xx1), xy(xy1), x0(x01), yx(yx1), yy(yy1), y0(y01) {}
+
+	static affine2 identity() noexcept { return affine2(1.0, 0.0, 0.0, 0.0, 1.0, 0.0); }
+	static affine2 translate(F x, F y) noexcept { return affine2(1.0, 0.0, x, 0.0, 1.0, y); }
+	static affine2 scale(F x, F y) noexcept { return affine2(x, 0.0, 0.0, 0.0, y, 0.0); }
+	static affine2 rotate(F radians) noexcept { const F c = cos(radians); const F s = sin(radians); return affine2(c, -s, 0.0, s, c, 0.0); }
+
+	//True if x' only depends on x, and y' only on y.  (No rotation or shear)
+	bool is_axis_aligned() const noexcept { return xy == 0.0 && yx == 0.0; }
+
+	//Convert to another type.  (eg. double to a SIMD type)
+	template <typename F2>
+	affine2<F2> to() const noexcept {
+		const auto c = [](F v) { if constexpr (SimdFloat<F2>) return F2(static_cast<typename F2::F>(v)); else return static_cast<F2>(v); };
+		return affine2<F2>(c(xx), c(xy), c(x0), c(yx), c(yy), c(y0));
+	}
+
+	[[nodiscard("Value Calculated and not used (apply)")]]
+	inline vec2<F> apply(const vec2<F>& p) const noexcept {
+		if constexpr (SimdFloat<F>) {
+			return vec2<F>(fma(xx, p.x, fma(xy, p.y, x0)), fma(yx, p.x, fma(yy, p.y, y0)));
+		}else {
+			return vec2<F>(xx * p.x + xy * p.y + x0, yx * p.x + yy * p.y + y0);
+		}
+	}
+};
+
+//Combine two transforms: (lhs * rhs).apply(p) == lhs.apply(rhs.apply(p))
+template <typename F>
+inline affine2<F> operator*(const affine2<F>& lhs, const affine2<F>& rhs) noexcept {
+	return affine2<F>(
+		lhs.xx * rhs.xx + lhs.xy * rhs.yx, lhs.xx * rhs.xy + lhs.xy * rhs.yy, lhs.xx * rhs.x0 + lhs.xy * rhs.y0 + lhs.x0,
+		lhs.yx * rhs.xx + lhs.yy * rhs.yx, lhs.yx * rhs.xy + lhs.yy * rhs.yy, lhs.yx * rhs.x0 + lhs.yy * rhs.y0 + lhs.y0
+	);
+}
+
+template <typename F> inline vec2<F> operator*(const affine2<F>& m, const vec2<F>& v) noexcept { return m.apply(v); }
+
+
+
+
 
 /**************************************************************************************************
  * A 3-Vector (x,y,z)
@@ -41,6 +41,12 @@ Description:
 #include <cmath>
 #include <limits>
 #include <bit>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <immintrin.h>
 #include <concepts>
 
@@ -76,18 +82,58 @@ inline constexpr U64 split_mix_64(U64 state) {
     return z ^ (z >> 31);
 }
 
-/*************************************************************************************************
- * Gets a random float in range 0..1
-  * Use state variable on first call only to set seed.
+/**************************************************************************************************
+ * 64-bit hash built only from 32x32->64 bit multiplies.
+ * Without AVX-512DQ there is no 64-bit SIMD multiply, so each split_mix_64 multiply is emulated.
+ * Here each round multiplies the low and high halves by a 32-bit constant (one _mm256_mul_epu32 each)
+ * and swaps the halves of one product, so every output bit depends on both halves.
+ * (Similar avalanche to split_mix_64 over the 52 bits used for doubles, but a different pattern)
  * ************************************************************************************************/
-template <std::floating_point F>
-F next_random(uint64_t state = 0) {
-    static uint64_t random_state;
-    if (state != 0) random_state = state;
-    random_state = split_mix_64(random_state) & bits_52; 
-    return static_cast<F>(random_state) / static_cast<F>(bits_52); 
+inline constexpr uint64_t multiply_low_32(uint64_t a, uint64_t b) {
+    return (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
 }
 
+template <typename U64> requires std::same_as<U64, uint64_t> || SimdUInt64<U64>
+inline constexpr U64 hash_64_mul32(U64 state) {
+    U64 z = state + 0x9e3779b97f4a7c15;
+    for (int round = 0; round < 2; round++) {
+        const U64 high = multiply_low_32(z >> 32, U64(0xc2b2ae35));
+        z = multiply_low_32(z, U64(0x85ebca6b)) ^ ((high << 32) | (high >> 32));
+        z ^= z >> 29;
+    }
+    return z;
+}
+
+/**************************************************************************************************
+ * The 64-bit hash used by noise for 64-bit float types.
+ * split_mix_64 when the compiler targets AVX-512DQ (native 64-bit multiplies), otherwise hash_64_mul32.
+ * All types use the same choice in one build, but AVX-512DQ builds render a different pattern.
+ * ************************************************************************************************/
+inline constexpr bool hash_64_uses_mul32 = !mt::environment::compiler_has_avx512dq;
+
+template <typename U64> requires std::same_as<U64, uint64_t> || SimdUInt64<U64>
+inline constexpr U64 hash_64(U64 state) {
+    if constexpr (hash_64_uses_mul32) return hash_64_mul32(state);
+    else return split_mix_64(state);
+}
+
+/*************************************************************************************************
+ * A stream of random floats in range 0..1, derived from a seed & a stream number.
+ * Stateless:  at(i) only depends on the seed, stream number & i, so any thread can read any part of a stream
+ * in any order and get the same values.  (Replaces next_random, which kept its state in a function static)
+ * ************************************************************************************************/
+class RandomStream {
+    uint64_t key;
+
+public:
+    explicit constexpr RandomStream(uint64_t seed, uint64_t stream = 0) noexcept
+        : key(split_mix_64(seed ^ split_mix_64(stream))) {}
+
+    template <std::floating_point F>
+    constexpr F at(uint64_t index) const noexcept {
+        return static_cast<F>(split_mix_64(key + index) & bits_52) / static_cast<F>(bits_52);
+    }
+};
 
 
 /***************************************************************************************************
@@ -106,6 +152,24 @@ inline constexpr U32 hash_32(U32 data, S32 seed) {
     //data = data * 5 + 0xe6546b64;
     return data;
 }
+
+/***************************************************************************************************
+* hash_32 split into two halves:  hash_32(data, seed) == hash_32_combine(hash_32_mix(data), seed)
+* The mix only depends on the data, so it can be shared when the same value is hashed with many seeds.
+**************************************************************************************************/
+template <typename U32> requires std::same_as<U32, uint32_t> || SimdUInt32<U32>
+inline constexpr U32 hash_32_mix(U32 data) {
+    data *= 0xcc9e2d51;
+    data = (data << 15) | (data >> 17);
+    data *= 0x1b873593;
+    return data;
+}
+template <typename U32, typename S32> requires (std::same_as<U32, uint32_t> || SimdUInt32<U32>) && (std::same_as<S32, uint32_t> || SimdUInt32<S32>)
+inline constexpr U32 hash_32_combine(U32 mixed, S32 seed) {
+    mixed ^= seed;
+    mixed = (mixed << 13) | (mixed >> 19);
+    return mixed;
+}
 template <typename U32> requires std::same_as<U32, uint32_t> || SimdUInt32<U32>
 inline constexpr U32 hash_32_final(U32 data) {
     //data *= 0xcc9e2d51;
@@ -172,49 +236,273 @@ inline S hash(const vec4<S>& coordinate, uint32_t seed ) {
     return result;
 }
 
+/**************************************************************************************************
+ * Finalise a hash_32 chain and convert to a float in range 0..1 (as used by hash() above)
+ * ************************************************************************************************/
+template <SimdFloat32 S, typename U32>
+inline S hash_32_to_float(U32 r) {
+    r = hash_32_final(r);
+    return S::make_from_int32(r >> 9) / S(0xffffffff >> 9);
+}
+
 template <SimdFloat64 S>
 inline S hash(const S& coordinate, uint64_t seed = 1) {
-    auto seed64 = S::U64(seed);
-    seed64 ^= coordinate.x.bitcast_to_uint64();
-    auto r = split_mix_64(seed64);
+    auto seed64 = typename S::U64(seed);
+    seed64 ^= coordinate.bitcast_to_uint();
+    auto r = hash_64(seed64);
     auto f = S::make_from_uints_52bits(r);
     return f / S(static_cast<double>(bits_52));
 }
 
 template <SimdFloat64 S>
 inline S hash(const vec2<S>& coordinate, uint64_t seed = 1) {
-    auto seed64 = S::U64(seed);
+    auto seed64 = typename S::U64(seed);
     seed64 ^= coordinate.x.bitcast_to_uint();
     seed64 ^= rotr(coordinate.y.bitcast_to_uint(), 32);
-    auto r = split_mix_64(seed64);
+    auto r = hash_64(seed64);
     auto f = S::make_from_uints_52bits(r);
     return f / S(static_cast<double>(bits_52));
 }
 
 template <SimdFloat64 S>
 inline S hash(const vec3<S>& coordinate, uint64_t seed = 1) {
-    auto seed64 = S::U64(seed);
-    seed64 ^= coordinate.x.bitcast_to_uint64();
-    seed64 ^= rotr(coordinate.y.bitcast_to_uint64(), 21);
-    seed64 ^= rotr(coordinate.z.bitcast_to_uint64(), 42);
-    auto r = split_mix_64(seed64);
+    auto seed64 = typename S::U64(seed);
+    seed64 ^= coordinate.x.bitcast_to_uint();
+    seed64 ^= rotr(coordinate.y.bitcast_to_uint(), 21);
+    seed64 ^= rotr(coordinate.z.bitcast_to_uint(), 42);
+    auto r = hash_64(seed64);
     auto f = S::make_from_uints_52bits(r);
     return f / S(static_cast<double>(bits_52));
 }
 
 template <SimdFloat64 S>
 inline S hash(const vec4<S> & coordinate, uint64_t seed = 1){
-    auto seed64 = S::U64(seed);
+    auto seed64 = typename S::U64(seed);
     seed64 ^= coordinate.x.bitcast_to_uint();
     seed64 ^= rotr(coordinate.y.bitcast_to_uint(), 16);
     seed64 ^= rotr(coordinate.z.bitcast_to_uint(), 32);
     seed64 ^= rotr(coordinate.w.bitcast_to_uint(), 48);        
-    auto r = split_mix_64(seed64);
+    auto r = hash_64(seed64);
     auto f = S::make_from_uints_52bits(r); 
     return f / S(static_cast<double>(bits_52));
 }
 
 
+/**************************************************************************************************
+Lattice coordinates used by value noise.
+
+float_bits: Hashes the bit pattern of the floored float coordinate. (Default, the original look)
+integer:    Converts the floored coordinate to int32 once, and gets the +1 corner with an integer add.
+            Cheaper and stays exact for large coordinates (where i + 1.0 == i in float), but gives a
+            different (equally random) pattern.  Only applies to 32-bit float types.
+*************************************************************************************************/
+enum class NoiseLattice {
+    float_bits,
+    integer,
+};
+
+//Hashable bits of the lower (0) and upper (1) lattice coordinate on one axis. (i must already be floored)
+template <NoiseLattice lattice, SimdFloat32 F>
+inline auto lattice_axis_bits(const F& i) {
+    if constexpr (lattice == NoiseLattice::integer) {
+        const auto cell = i.truncate_to_int32();
+        return std::array{ cell.bitcast_to_uint(), (cell + 1).bitcast_to_uint() };
+    }
+    else {
+        return std::array{ (i + F(0.0)).bitcast_to_uint(), (i + F(1.0)).bitcast_to_uint() };
+    }
+}
+
+
+/**************************************************************************************************
+Packet-uniform lattice cells.
+
+A wide packet (16 horizontally adjacent pixels for Simd512Float32) is almost always inside one
+lattice cell at coarse octaves.  The corners are then hashed once with scalar code and broadcast
+to every lane, rather than running full width vector hashes for all corners.
+Bit-identical to the vector path, as the hash chain is integer only and the float conversion is exact.
+*************************************************************************************************/
+//True if every lane is in the same cell. (i must already be floored)
+template <typename F> requires SimdFloat<F>
+inline bool lattice_cell_is_uniform(const vec4<F>& i) {
+    if constexpr (SimdFloat32<F>) {
+        return is_uniform(i.x) & is_uniform(i.y) & is_uniform(i.z) & is_uniform(i.w);
+    }
+    else {
+        for (int lane = 1; lane < F::number_of_elements(); lane++) {
+            if (i.x.element(lane) != i.x.element(0) || i.y.element(lane) != i.y.element(0) || 
+                i.z.element(lane) != i.z.element(0) || i.w.element(lane) != i.w.element(0)) return false;
+        }
+        return true;
+    }
+}
+
+template <SimdFloat32 F>
+inline bool lattice_cell_is_uniform(const vec2<F>& i) {
+    return is_uniform(i.x) & is_uniform(i.y);
+}
+
+//Copies scalar corner hashes to every lane.
+template <SimdFloat32 F, size_t N>
+inline std::array<F, N> lattice_broadcast_corners(const std::array<FallbackFloat32, N>& scalar) {
+    std::array<F, N> corners;
+    for (size_t c = 0; c < N; c++) corners[c] = F(scalar[c].v);
+    return corners;
+}
+
+
+/**************************************************************************************************
+Lattice corner hashes for value noise.
+Returns the hash of each cell corner, i + (a,b,...) where a,b.. are 0 or 1.
+Corner index bits are: x = 1, y = 2, z = 4, w = 8.
+
+For 32-bit types the corners are hashed as a tree, as corners share coordinate prefixes.
+x0/x1 are hashed once and extended with y0/y1, then z, then w.  4D takes 30 hash rounds rather than 64.
+(Bit-identical to hashing each corner separately)
+
+Packets with every lane in one cell take the packet-uniform path above.
+*************************************************************************************************/
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline std::array<F, 4> lattice_corner_hashes(const vec2<F>& i, uint32_t seed) {
+    if constexpr (SimdFloat32<F> && F::number_of_elements() > 1) {
+        if (lattice_cell_is_uniform(i)) {
+            const vec2<FallbackFloat32> cell(FallbackFloat32(i.x.element(0)), FallbackFloat32(i.y.element(0)));
+            return lattice_broadcast_corners<F>(lattice_corner_hashes<lattice>(cell, seed));
+        }
+    }
+    if constexpr (SimdFloat32<F>) {
+        const auto bx = lattice_axis_bits<lattice>(i.x);
+        const auto by = lattice_axis_bits<lattice>(i.y);
+        const auto mx0 = hash_32_mix(bx[0]);
+        const auto mx1 = hash_32_mix(bx[1]);
+        const auto my0 = hash_32_mix(by[0]);
+        const auto my1 = hash_32_mix(by[1]);
+
+        const auto hx0 = hash_32_combine(mx0, seed);
+        const auto hx1 = hash_32_combine(mx1, seed);
+
+        return {
+            hash_32_to_float<F>(hash_32_combine(my0, hx0)),
+            hash_32_to_float<F>(hash_32_combine(my0, hx1)),
+            hash_32_to_float<F>(hash_32_combine(my1, hx0)),
+            hash_32_to_float<F>(hash_32_combine(my1, hx1)),
+        };
+    }
+    else {
+        return {
+            hash(i + vec2<F>(0.0, 0.0), seed),
+            hash(i + vec2<F>(1.0, 0.0), seed),
+            hash(i + vec2<F>(0.0, 1.0), seed),
+            hash(i + vec2<F>(1.0, 1.0), seed),
+        };
+    }
+}
+
+/**************************************************************************************************
+Corner-parallel lattice hashes, for a single pixel.
+
+Scalar renderers (FallbackFloat32, the only type in the WASM hosts) hash one corner at a time.
+This vectorizes across the 16 corners of one 4D cell instead.  x & y are hashed as a scalar tree,
+then each lane is a corner and picks its z/w bits by the lane number, so z, w & the final hash
+run in 16 / C::number_of_elements() vectors.  (One AVX-512 vector, two AVX2 or four SSE.
+With C = FallbackFloat32 it is a 16 iteration loop of independent lanes, for the compiler to vectorize)
+Bit-identical to lattice_corner_hashes.  Used by NoiseBasis::value_parallel_corners.
+
+Slower in practice: one pixel's corners are a single dependency chain through 32-bit vector multiplies
+(~10 cycle latency vs 3 for scalar), so the scalar tree's 16 independent chains overlap better.
+*************************************************************************************************/
+template <NoiseLattice lattice = NoiseLattice::float_bits, SimdFloat32 C = SimdNativeFloat32>
+inline std::array<FallbackFloat32, 16> lattice_corner_hashes_parallel(const vec4<FallbackFloat32>& i, uint32_t seed) {
+    using U = typename C::U;
+    constexpr int lanes = C::number_of_elements();
+
+    //x & y as a scalar tree (each xy prefix is shared by 4 corners)
+    const auto bx = lattice_axis_bits<lattice>(i.x);
+    const auto by = lattice_axis_bits<lattice>(i.y);
+    const auto bz = lattice_axis_bits<lattice>(i.z);
+    const auto bw = lattice_axis_bits<lattice>(i.w);
+    const auto hx0 = hash_32_combine(hash_32_mix(bx[0]), seed);
+    const auto hx1 = hash_32_combine(hash_32_mix(bx[1]), seed);
+    const auto my0 = hash_32_mix(by[0]);
+    const auto my1 = hash_32_mix(by[1]);
+    const std::array<uint32_t, 4> hxy{ hash_32_combine(my0, hx0).v, hash_32_combine(my0, hx1).v, hash_32_combine(my1, hx0).v, hash_32_combine(my1, hx1).v };
+    const std::array<uint32_t, 2> mz{ hash_32_mix(bz[0]).v, hash_32_mix(bz[1]).v };
+    const std::array<uint32_t, 2> mw{ hash_32_mix(bw[0]).v, hash_32_mix(bw[1]).v };
+
+    //z & w across lanes.  (Lane values are picked by the bits of the corner number)
+    std::array<FallbackFloat32, 16> corners;
+    for (int first = 0; first < 16; first += lanes) {
+        const U corner = U::make_sequential(static_cast<uint32_t>(first));
+        const auto select = [&corner](int bit, uint32_t a, uint32_t b) { return U(a) ^ (U(a ^ b) & (U(0) - ((corner >> bit) & U(1)))); };
+        const U hxy_low = select(0, hxy[0], hxy[1]);
+        const U hxy_high = select(0, hxy[2], hxy[3]);
+        U r = hxy_low ^ ((hxy_low ^ hxy_high) & (U(0) - ((corner >> 1) & U(1))));
+        r = hash_32_combine(select(2, mz[0], mz[1]), r);
+        r = hash_32_combine(select(3, mw[0], mw[1]), r);
+        const C h = hash_32_to_float<C>(r);
+        for (int lane = 0; lane < lanes; lane++) corners[first + lane] = FallbackFloat32(h.element(lane));
+    }
+    return corners;
+}
+
+
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline std::array<F, 16> lattice_corner_hashes(const vec4<F>& i, uint32_t seed) {
+    if constexpr (SimdFloat32<F> && F::number_of_elements() > 1) {
+        if (lattice_cell_is_uniform(i)) {
+            const vec4<FallbackFloat32> cell(FallbackFloat32(i.x.element(0)), FallbackFloat32(i.y.element(0)), FallbackFloat32(i.z.element(0)), FallbackFloat32(i.w.element(0)));
+            return lattice_broadcast_corners<F>(lattice_corner_hashes<lattice>(cell, seed));
+        }
+    }
+    std::array<F, 16> corners;
+    if constexpr (SimdFloat32<F>) {
+        const auto bx = lattice_axis_bits<lattice>(i.x);
+        const auto by = lattice_axis_bits<lattice>(i.y);
+        const auto bz = lattice_axis_bits<lattice>(i.z);
+        const auto bw = lattice_axis_bits<lattice>(i.w);
+        const auto mx0 = hash_32_mix(bx[0]);
+        const auto mx1 = hash_32_mix(bx[1]);
+        const auto my0 = hash_32_mix(by[0]);
+        const auto my1 = hash_32_mix(by[1]);
+        const auto mz0 = hash_32_mix(bz[0]);
+        const auto mz1 = hash_32_mix(bz[1]);
+        const auto mw0 = hash_32_mix(bw[0]);
+        const auto mw1 = hash_32_mix(bw[1]);
+
+        const auto hx0 = hash_32_combine(mx0, seed);
+        const auto hx1 = hash_32_combine(mx1, seed);
+
+        const auto hxy00 = hash_32_combine(my0, hx0);
+        const auto hxy10 = hash_32_combine(my0, hx1);
+        const auto hxy01 = hash_32_combine(my1, hx0);
+        const auto hxy11 = hash_32_combine(my1, hx1);
+
+        const decltype(hx0) hxyz[8] = {
+            hash_32_combine(mz0, hxy00),
+            hash_32_combine(mz0, hxy10),
+            hash_32_combine(mz0, hxy01),
+            hash_32_combine(mz0, hxy11),
+            hash_32_combine(mz1, hxy00),
+            hash_32_combine(mz1, hxy10),
+            hash_32_combine(mz1, hxy01),
+            hash_32_combine(mz1, hxy11),
+        };
+
+        for (int c = 0; c < 8; c++) {
+            corners[c] = hash_32_to_float<F>(hash_32_combine(mw0, hxyz[c]));
+            corners[c + 8] = hash_32_to_float<F>(hash_32_combine(mw1, hxyz[c]));
+        }
+    }
+    else {
+        for (int c = 0; c < 16; c++) {
+            const vec4<F> offset(F(c & 1 ? 1.0 : 0.0), F(c & 2 ? 1.0 : 0.0), F(c & 4 ? 1.0 : 0.0), F(c & 8 ? 1.0 : 0.0));
+            corners[c] = hash<F>(i + offset, seed);
+        }
+    }
+    return corners;
+}
+
+
 /**************************************************************************************************
 Value Noise
 
@@ -223,6 +511,9 @@ Parameter 1
        (can be simple or SIMD type)
 
     seed: 32-bit seed value for the hash function.
+
+Template Parameter (vec2 & vec4 only)
+    lattice: See NoiseLattice.
 *************************************************************************************************/
 template <typename F> requires SimdFloat<F> || std::floating_point<F>
 inline F value_noise(const F & p, uint32_t seed = 1) {
@@ -237,19 +528,15 @@ inline F value_noise(const F & p, uint32_t seed = 1) {
 }
 
 
-template <typename F> requires SimdFloat<F> || std::floating_point<F>
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F> || std::floating_point<F>
 inline F value_noise(const vec2<F>& p , uint32_t seed=1){
     vec2<F> i = floor(p);
     vec2<F> f = fract(p);  
     vec2<F> u = f*f*(static_cast<F>(3.0)- (f + f));
     
-    const F x1 = hash(i + vec2<F>(0.0, 0.0), seed);
-    const F x2 = hash(i + vec2<F>(1.0, 0.0), seed);
-    const F y1 = mix(x1, x2, u.x);
-    
-    const F x3 = hash(i + vec2<F>(0.0, 1.0), seed);
-    const F x4 = hash(i + vec2<F>(1.0, 1.0), seed);
-    const F y2 = mix(x3, x4, u.x);
+    const auto corner = lattice_corner_hashes<lattice>(i, seed);
+    const F y1 = mix(corner[0], corner[1], u.x);
+    const F y2 = mix(corner[2], corner[3], u.x);
    
     return mix(y1, y2 , u.y);
 }
@@ -282,53 +569,516 @@ inline F value_noise(const vec3<F>& p, uint32_t seed = 0) {
     return mix(z1, z2, u.z);
 }
 
+//Interpolates the 16 corner hashes of a 4D cell. (u is the smoothed fractional position)
 template <typename F> requires SimdFloat<F> || std::floating_point<F>
-inline F value_noise(const vec4<F>& p, uint32_t seed = 0) {
-    vec4<F> i = floor(p);
-    vec4<F> f = fract(p);  
-    vec4<F> u = f * f * (static_cast<F>(3.0) - (f + f));
-
-    const F x1 = hash<F>(i + vec4<F>(0.0, 0.0, 0.0, 0.0), seed);
-    const F x2 = hash<F>(i + vec4<F>(1.0, 0.0, 0.0, 0.0), seed);
-    const F y1 = mix(x1, x2, u.x);
-
-    const F x3 = hash<F>(i + vec4<F>(0.0, 1.0, 0.0, 0.0), seed);
-    const F x4 = hash<F>(i + vec4<F>(1.0, 1.0, 0.0, 0.0), seed);
-    const F y2 = mix(x3, x4, u.x);
+inline F value_noise_interpolate(const std::array<F, 16>& corner, const vec4<F>& u) {
+    const F y1 = mix(corner[0], corner[1], u.x);
+    const F y2 = mix(corner[2], corner[3], u.x);
     const F z1 = mix(y1, y2, u.y);
 
-    const F x5 = hash<F>(i + vec4<F>(0.0, 0.0, 1.0, 0.0), seed);
-    const F x6 = hash<F>(i + vec4<F>(1.0, 0.0, 1.0, 0.0), seed);
-    const F y3 = mix(x5, x6, u.x);
-
-    const F x7 = hash<F>(i + vec4<F>(0.0, 1.0, 1.0, 0.0), seed);
-    const F x8 = hash<F>(i + vec4<F>(1.0, 1.0, 1.0, 0.0), seed);
-    const F y4 = mix(x7, x8, u.x);
+    const F y3 = mix(corner[4], corner[5], u.x);
+    const F y4 = mix(corner[6], corner[7], u.x);
     const F z2 = mix(y3, y4, u.y);
     const F w1 = mix(z1, z2, u.z);
     
-    const F x9 = hash<F>(i + vec4<F>(0.0, 0.0, 0.0, 1.0), seed);
-    const F x10 = hash<F>(i + vec4<F>(1.0, 0.0, 0.0, 1.0), seed);
-    const F y5 = mix(x9, x10, u.x);
-
-    const F x11 = hash<F>(i + vec4<F>(0.0, 1.0, 0.0, 1.0), seed);
-    const F x12 = hash<F>(i + vec4<F>(1.0, 1.0, 0.0, 1.0), seed);
-    const F y6 = mix(x11, x12, u.x);
+    const F y5 = mix(corner[8], corner[9], u.x);
+    const F y6 = mix(corner[10], corner[11], u.x);
     const F z3 = mix(y5, y6, u.y);
     
-    const F x13 = hash<F>(i + vec4<F>(0.0, 0.0, 1.0, 1.0), seed);
-    const F x14 = hash<F>(i + vec4<F>(1.0, 0.0, 1.0, 1.0), seed);
-    const F y7 = mix(x13, x14, u.x);
-
-    const F x15 = hash<F>(i + vec4<F>(0.0, 1.0, 1.0, 1.0), seed);
-    const F x16 = hash<F>(i + vec4<F>(1.0, 1.0, 1.0, 1.0), seed);
-    const F y8 = mix(x15, x16, u.x);
+    const F y7 = mix(corner[12], corner[13], u.x);
+    const F y8 = mix(corner[14], corner[15], u.x);
     const F z4 = mix(y7, y8, u.y);
     const F w2 = mix(z3, z4, u.z);  
 
     return mix(w1, w2, u.w);
 }
 
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F> || std::floating_point<F>
+inline F value_noise(const vec4<F>& p, uint32_t seed = 0) {
+    vec4<F> i = floor(p);
+    vec4<F> f = fract(p);  
+    vec4<F> u = f * f * (static_cast<F>(3.0) - (f + f));
+
+    return value_noise_interpolate(lattice_corner_hashes<lattice>(i, seed), u);
+}
+
+
+/**************************************************************************************************
+Lattice cache for low frequency octaves.
+
+At coarse octaves a lattice cell spans hundreds of pixels, so neighbouring packets hash the same
+16 corners over and over.  LatticeCache keeps the corner hashes of recently used 4D cells.
+It is only used when every lane of a packet is in the same cell (almost always at coarse octaves),
+other packets are hashed directly.  Results are identical with or without the cache.
+
+Corner hashes only depend on the cell and the seed, so entries stay valid across octaves, fbm calls,
+tiles & frames.  The cache is cleared when the seed changes.
+Not thread safe, use one cache per thread.
+*************************************************************************************************/
+template <SimdFloat F>
+class LatticeCache {
+    using T = typename F::F;
+    static constexpr int size_bits = 6;
+    static constexpr uint32_t size = 1u << size_bits;   //Direct mapped.  (5KB for float, so it stays in L1 cache)
+
+    struct Entry {
+        std::array<T, 4> cell{};
+        std::array<T, 16> corners{};
+        bool valid{};
+    };
+
+    std::array<Entry, size> entries{};
+    uint32_t seed{};
+
+public:
+    //Statistics (hits + misses + bypassed = number of lookups)
+    uint64_t hits{};        //Found in the cache
+    uint64_t misses{};      //Hashed & stored
+    uint64_t bypassed{};    //Lanes were in different cells, hashed directly
+
+    double hit_rate() const {
+        const auto lookups = hits + misses + bypassed;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+    void reset_statistics() { hits = misses = bypassed = 0; }
+    void clear() { for (auto& e : entries) e.valid = false; }
+
+    //Corner hashes of cell i (i must already be floored), as lattice_corner_hashes()
+    template <NoiseLattice lattice>
+    std::array<F, 16> corner_hashes(const vec4<F>& i, uint32_t s) {
+        if (!lattice_cell_is_uniform(i)) {
+            bypassed++;
+            return lattice_corner_hashes<lattice>(i, s);
+        }
+        const std::array<T, 4> cell{ i.x.element(0), i.y.element(0), i.z.element(0), i.w.element(0) };
+
+        if (s != seed) {
+            clear();
+            seed = s;
+        }
+
+        uint32_t key = 0;
+        for (const T c : cell) {
+            const auto bits = static_cast<uint64_t>(std::bit_cast<std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>>(c));
+            key = (key ^ static_cast<uint32_t>(bits ^ (bits >> 32))) * 0x9E3779B1u;
+        }
+        auto& entry = entries[key >> (32 - size_bits)];    //High bits mix in all of the key
+
+        std::array<F, 16> corners;
+        if (entry.valid && entry.cell == cell) {
+            hits++;
+            for (int c = 0; c < 16; c++) corners[c] = F(entry.corners[c]);
+            return corners;
+        }
+
+        misses++;
+        corners = lattice_corner_hashes<lattice>(i, s);
+        entry.cell = cell;
+        for (int c = 0; c < 16; c++) entry.corners[c] = corners[c].element(0);
+        entry.valid = true;
+        return corners;
+    }
+};
+
+//Value noise with the corners looked up in a LatticeCache.  (Same result as value_noise)
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline F value_noise(const vec4<F>& p, uint32_t seed, LatticeCache<F>& cache) {
+    vec4<F> i = floor(p);
+    vec4<F> f = fract(p);  
+    vec4<F> u = f * f * (static_cast<F>(3.0) - (f + f));
+
+    return value_noise_interpolate(cache.template corner_hashes<lattice>(i, seed), u);
+}
+
+
+/**************************************************************************************************
+Lattice table for 2D value noise.
+
+2D noise stages that don't depend on evolve read the same lattice values every frame.  LatticeTable
+holds the value of every lattice point in [-half_width, half_width) on both axes, built once per seed.
+The value of a point doesn't depend on the octave, so one table serves every octave.
+Corners are then 4 gathers rather than 4 hash chains.  Packets with a lane outside the table are
+hashed directly.  Results are identical to value_noise.  (Except for a cell at exactly -0.0 with
+NoiseLattice::float_bits, which reads the 0.0 cell)
+
+Read only once built, so one table can be shared by every thread.  shared() keeps the tables of the
+most recently used seeds for the whole process, so they persist across frames & renderer instances.
+32-bit float types only.  (16MB per table, so the renderer leaves it out of the scalar / WASM build)
+*************************************************************************************************/
+class LatticeTable {
+public:
+    static constexpr int size_bits = 11;
+    static constexpr uint32_t size = 1u << size_bits;   //Points per axis. (16MB, only the parts near the warped image are touched)
+    static constexpr uint32_t mask = size - 1;
+    static constexpr int half_width = static_cast<int>(size / 2);
+    static constexpr int shared_tables = 2;             //Seeds kept by shared()
+
+private:
+    std::vector<float> values;      //Point (x, y) is at ((y & mask) << size_bits) | (x & mask)
+    uint32_t seed{};
+    NoiseLattice lattice{};
+
+public:
+    //Builds the table for a seed.  (Do this once per seed, not per frame)
+    template <NoiseLattice L>
+    static LatticeTable build(uint32_t s) {
+        using T = FallbackFloat32;
+        LatticeTable table;
+        table.seed = s;
+        table.lattice = L;
+        table.values.resize(static_cast<size_t>(size) * size);
+
+        //The chain is x then y, so the x part is shared by each column.
+        std::vector<FallbackUInt32> hx(size);
+        std::vector<FallbackUInt32> my(size);
+        for (int c = -half_width; c < half_width; c++) {
+            const auto bits = lattice_axis_bits<L>(T(static_cast<float>(c)))[0];
+            hx[c & mask] = hash_32_combine(hash_32_mix(bits), s);
+            my[c & mask] = hash_32_mix(bits);
+        }
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                table.values[(y << size_bits) | x] = hash_32_to_float<T>(hash_32_combine(my[y], hx[x])).v;
+            }
+        }
+        return table;
+    }
+
+    //The table for a seed, shared by the whole process.  (Thread safe, builds on first use)
+    template <NoiseLattice L>
+    static std::shared_ptr<const LatticeTable> shared(uint32_t s) {
+        static std::mutex mutex;
+        static std::array<std::shared_ptr<const LatticeTable>, shared_tables> recent{};    //Most recent first
+        std::scoped_lock lock(mutex);
+
+        auto found = std::find_if(recent.begin(), recent.end(), [&](const auto& t) { return t && t->template matches<L>(s); });
+        if (found == recent.end()) {
+            found = recent.end() - 1;
+            *found = std::make_shared<const LatticeTable>(build<L>(s));
+        }
+        std::rotate(recent.begin(), found, found + 1);
+        return recent.front();
+    }
+
+    template <NoiseLattice L>
+    bool matches(uint32_t s) const {
+        return lattice == L && seed == s;
+    }
+
+    //Corner hashes of cell i (i must already be floored), as lattice_corner_hashes()
+    template <NoiseLattice L, SimdFloat32 F>
+    std::array<F, 4> corner_hashes(const vec2<F>& i, uint32_t s) const {
+        using U = typename F::U;
+        const auto lo = reduce_min(min(i.x, i.y));
+        const auto hi = reduce_max(max(i.x, i.y));
+        if (!(lo >= -half_width && hi < half_width - 1) || !matches<L>(s)) return lattice_corner_hashes<L>(i, s);
+
+        //(Indices are masked, so always inside the table even if the range check is passed by a NaN)
+        const U x0 = i.x.truncate_to_int32().bitcast_to_uint() & U(mask);
+        const U y0 = (i.y.truncate_to_int32().bitcast_to_uint() & U(mask)) << size_bits;
+        const U x1 = (x0 + 1) & U(mask);
+        const U y1 = (y0 + size) & U(mask << size_bits);
+        return {
+            gather(values.data(), y0 | x0),
+            gather(values.data(), y0 | x1),
+            gather(values.data(), y1 | x0),
+            gather(values.data(), y1 | x1),
+        };
+    }
+};
+
+//2D value noise with the corners looked up in a LatticeTable.  (Same result as value_noise)
+template <NoiseLattice lattice = NoiseLattice::float_bits, SimdFloat32 F>
+inline F value_noise(const vec2<F>& p, uint32_t seed, const LatticeTable& table) {
+    vec2<F> i = floor(p);
+    vec2<F> f = fract(p);
+    vec2<F> u = f * f * (static_cast<F>(3.0) - (f + f));
+
+    const auto corner = table.template corner_hashes<lattice>(i, seed);
+    const F y1 = mix(corner[0], corner[1], u.x);
+    const F y2 = mix(corner[2], corner[3], u.x);
+    return mix(y1, y2, u.y);
+}
+
+
+/**************************************************************************************************
+4D Simplex Noise
+Based on "Simplex noise demystified" by Stefan Gustavson (public domain).
+A simplex cell in 4D has 5 corners, rather than the 16 corners of a hypercube used by value noise.
+
+Corners are hashed with the same hash chain as value noise.  The top 5 bits of the hash pick one of
+32 gradients (a 4D vector with one zero component and the others +/- 1).
+For 32-bit types the per-axis hash mixes are shared between corners, as each corner coordinate is
+either i or i+1 on each axis.
+
+Returns a value in range 0..1 (centered on 0.5) so it can replace value_noise.
+*************************************************************************************************/
+
+//Dot product of a gradient with d.  h (0..1) selects the gradient, only the top 5 bits are used.
+template <typename F> requires SimdFloat<F>
+inline F simplex_gradient_dot(F h, const vec4<F>& d) {
+    h *= 4.0;
+    const F axis = floor(h);    //Component of the gradient that is zero (0..3)
+    h -= axis;
+    h *= 2.0; const F sx = floor(h); h -= sx;
+    h *= 2.0; const F sy = floor(h); h -= sy;
+    h *= 2.0; const F sz = floor(h); h -= sz;
+    h *= 2.0; const F sw = floor(h);
+
+    const F gx = (F(1.0) - (sx + sx)) * min(abs(axis), F(1.0));
+    const F gy = (F(1.0) - (sy + sy)) * min(abs(axis - F(1.0)), F(1.0));
+    const F gz = (F(1.0) - (sz + sz)) * min(abs(axis - F(2.0)), F(1.0));
+    const F gw = (F(1.0) - (sw + sw)) * min(abs(axis - F(3.0)), F(1.0));
+    return gx * d.x + gy * d.y + gz * d.z + gw * d.w;
+}
+
+//Radial falloff of a corner's contribution.
+template <typename F> requires SimdFloat<F>
+inline F simplex_falloff(const vec4<F>& d) {
+    F t = max(F(0.6) - dot(d, d), F(0.0));
+    t *= t;
+    return t * t;
+}
+
+//Gradient selectors (0..1) for the 5 corners of the simplex: i, i+o1, i+o2, i+o3, i+1
+template <typename F> requires SimdFloat<F>
+inline std::array<F, 5> simplex_corner_hashes(const vec4<F>& i, const vec4<F>& o1, const vec4<F>& o2, const vec4<F>& o3, uint32_t seed) {
+    if constexpr (SimdFloat32<F>) {
+        const auto bx = lattice_axis_bits<NoiseLattice::float_bits>(i.x);
+        const auto by = lattice_axis_bits<NoiseLattice::float_bits>(i.y);
+        const auto bz = lattice_axis_bits<NoiseLattice::float_bits>(i.z);
+        const auto bw = lattice_axis_bits<NoiseLattice::float_bits>(i.w);
+        const std::array mx{ hash_32_mix(bx[0]), hash_32_mix(bx[1]) };
+        const std::array my{ hash_32_mix(by[0]), hash_32_mix(by[1]) };
+        const std::array mz{ hash_32_mix(bz[0]), hash_32_mix(bz[1]) };
+        const std::array mw{ hash_32_mix(bw[0]), hash_32_mix(bw[1]) };
+
+        //Select the lower or upper mix per element. (offset is 0 or 1)
+        auto select = [](const auto& m, const F& offset) {
+            const auto mask = (0 - offset.truncate_to_int32()).bitcast_to_uint();
+            return m[0] ^ ((m[0] ^ m[1]) & mask);
+        };
+        auto to_selector = [&](auto r) {
+            r = hash_32_final(r);
+            return F::make_from_int32(r >> 27) * F(1.0f / 32.0f);
+        };
+        auto corner_hash = [&](const vec4<F>& o) {
+            return to_selector(hash_32_combine(select(mw, o.w), hash_32_combine(select(mz, o.z), hash_32_combine(select(my, o.y), hash_32_combine(select(mx, o.x), seed)))));
+        };
+
+        return {
+            to_selector(hash_32_combine(mw[0], hash_32_combine(mz[0], hash_32_combine(my[0], hash_32_combine(mx[0], seed))))),
+            corner_hash(o1),
+            corner_hash(o2),
+            corner_hash(o3),
+            to_selector(hash_32_combine(mw[1], hash_32_combine(mz[1], hash_32_combine(my[1], hash_32_combine(mx[1], seed))))),
+        };
+    }
+    else {
+        return { hash<F>(i, seed), hash<F>(i + o1, seed), hash<F>(i + o2, seed), hash<F>(i + o3, seed), hash<F>(i + 1.0, seed) };
+    }
+}
+
+template <typename F> requires SimdFloat<F>
+inline F simplex_noise(const vec4<F>& p, uint32_t seed = 0) {
+    using T = typename F::F;
+    constexpr T F4 = static_cast<T>(0.309016994374947451);   //(sqrt(5) - 1) / 4
+    constexpr T G4 = static_cast<T>(0.138196601125010504);   //(5 - sqrt(5)) / 20
+
+    //Skew the input to find the cell, and unskew the cell origin
+    const vec4<F> i = floor(p + (p.x + p.y + p.z + p.w) * F4);
+    const F t = (i.x + i.y + i.z + i.w) * G4;
+    const vec4<F> d0 = p - (i - t);
+
+    //Rank the components to find which of the 24 simplices we are in
+    const F one = F(1.0);
+    const F zero = F(0.0);
+    const F xy = if_greater(d0.x, d0.y, one, zero);
+    const F xz = if_greater(d0.x, d0.z, one, zero);
+    const F xw = if_greater(d0.x, d0.w, one, zero);
+    const F yz = if_greater(d0.y, d0.z, one, zero);
+    const F yw = if_greater(d0.y, d0.w, one, zero);
+    const F zw = if_greater(d0.z, d0.w, one, zero);
+    const vec4<F> rank(xy + xz + xw, (one - xy) + yz + yw, (one - xz) + (one - yz) + zw, (one - xw) + (one - yw) + (one - zw));
+
+    //Offsets of the middle 3 corners (1 where rank >= 3, 2, 1)
+    auto rank_at_least = [&](T r) {
+        return vec4<F>(clamp(rank.x - r + one, T(0.0), T(1.0)), clamp(rank.y - r + one, T(0.0), T(1.0)), clamp(rank.z - r + one, T(0.0), T(1.0)), clamp(rank.w - r + one, T(0.0), T(1.0)));
+    };
+    const vec4<F> o1 = rank_at_least(3.0);
+    const vec4<F> o2 = rank_at_least(2.0);
+    const vec4<F> o3 = rank_at_least(1.0);
+
+    const vec4<F> d1 = d0 - o1 + G4;
+    const vec4<F> d2 = d0 - o2 + (2.0 * G4);
+    const vec4<F> d3 = d0 - o3 + (3.0 * G4);
+    const vec4<F> d4 = d0 - 1.0 + (4.0 * G4);
+
+    const auto h = simplex_corner_hashes(i, o1, o2, o3, seed);
+    const F n = simplex_falloff(d0) * simplex_gradient_dot(h[0], d0)
+        + simplex_falloff(d1) * simplex_gradient_dot(h[1], d1)
+        + simplex_falloff(d2) * simplex_gradient_dot(h[2], d2)
+        + simplex_falloff(d3) * simplex_gradient_dot(h[3], d3)
+        + simplex_falloff(d4) * simplex_gradient_dot(h[4], d4);
+
+    return F(0.5) + F(13.5) * n;  //27 * n is approximately -1..1
+}
+
+
+/**************************************************************************************************
+Noise basis used by fbm.
+value:   Value noise (16 corners in 4D).  The original look.
+simplex: 4D inputs use simplex_noise (5 corners).  An alternative look, but slower than value noise, which shares its
+         per axis hash mixes between all 16 corners.  2D inputs still use value noise.
+value_parallel_corners:  Value noise, with FallbackFloat32 4D inputs hashed by lattice_corner_hashes_parallel.
+         The same output as value.  (Lattice cache lookups still use the scalar tree)
+*************************************************************************************************/
+enum class NoiseBasis {
+    value,
+    simplex,
+    value_parallel_corners,
+};
+
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const vec2<F>& p, uint32_t seed) {
+    return value_noise<lattice>(p, seed);
+}
+
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const vec4<F>& p, uint32_t seed) {
+    if constexpr (basis == NoiseBasis::simplex) return simplex_noise(p, seed);
+    else if constexpr (basis == NoiseBasis::value_parallel_corners && std::same_as<F, FallbackFloat32>) {
+        const vec4<F> i = floor(p);
+        const vec4<F> f = fract(p);
+        const vec4<F> u = f * f * (static_cast<F>(3.0) - (f + f));
+        return value_noise_interpolate(lattice_corner_hashes_parallel<lattice>(i, seed), u);
+    }
+    else return value_noise<lattice>(p, seed);
+}
+
+//With an optional LatticeCache (nullptr for none).  Only 4D value noise uses the cache.
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const vec2<F>& p, uint32_t seed, LatticeCache<F>*) {
+    return value_noise<lattice>(p, seed);
+}
+
+//With an optional LatticeTable (nullptr for none).
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const vec2<F>& p, uint32_t seed, const LatticeTable* table) {
+    if constexpr (SimdFloat32<F>) {
+        if (table) return value_noise<lattice>(p, seed, *table);
+    }
+    return value_noise<lattice>(p, seed);
+}
+
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const vec4<F>& p, uint32_t seed, LatticeCache<F>* cache) {
+    if constexpr (basis != NoiseBasis::simplex) {
+        if (cache) return value_noise<lattice>(p, seed, *cache);
+    }
+    return basis_noise<basis, lattice>(p, seed);
+}
+
+
+/**************************************************************************************************
+Hybrid precision lattice coordinates.
+
+A float32 coordinate only has 24 bits, so at large values (high fbm octaves of large evolve offsets)
+the fraction within a lattice cell is quantised into visible steps.  LatticeCoordinate keeps the
+cell & the fraction apart, so the fraction keeps full float precision at any magnitude.
+The cell is an integer valued float, exact up to 2^24 (and hashed by either NoiseLattice policy).
+
+HybridVec4 is a 4D noise input with plain x/y (per pixel positions, where float precision is
+relative to the pixel spacing anyway) and hybrid z/w (per frame offsets, split in double on the host).
+It is a drop in replacement for vec4 in fbm, with the same look.  (Value noise only, simplex falls
+back to a float vec4)
+*************************************************************************************************/
+template <typename F> requires SimdFloat<F>
+struct LatticeCoordinate {
+    F cell{};   //Integer part
+    F frac{};   //Fractional part (0..1)
+
+    LatticeCoordinate() = default;
+    LatticeCoordinate(const F& c, const F& f) : cell(c), frac(f) {}
+
+    //Splits a per-frame constant in double precision.
+    static LatticeCoordinate from_double(double v) {
+        double c = std::floor(v);
+        auto f = static_cast<typename F::F>(v - c);
+        if (f >= static_cast<typename F::F>(1.0)) {  //(Rounded up to the next cell)
+            c += 1.0;
+            f = 0.0;
+        }
+        return LatticeCoordinate(F(static_cast<typename F::F>(c)), F(f));
+    }
+};
+
+//Adds a float, carrying whole cells of the sum into the cell.
+template <typename F> requires SimdFloat<F>
+inline LatticeCoordinate<F> operator+(const LatticeCoordinate<F>& a, const F& b) {
+    const F s = a.frac + b;
+    const F carry = floor(s);
+    return LatticeCoordinate<F>(a.cell + carry, s - carry);
+}
+
+//Scales by an fbm frequency.  (Exact for powers of two)
+template <typename F> requires SimdFloat<F>
+inline LatticeCoordinate<F> operator*(const F& f, const LatticeCoordinate<F>& a) {
+    const F s = a.frac * f;
+    const F carry = floor(s);
+    return LatticeCoordinate<F>(fma(a.cell, f, carry), s - carry);
+}
+
+template <typename F> requires SimdFloat<F>
+struct HybridVec4 {
+    vec2<F> xy{};
+    LatticeCoordinate<F> z{};
+    LatticeCoordinate<F> w{};
+
+    //Nearest float vec4.  (Loses the precision this type keeps)
+    vec4<F> to_vec4() const { return vec4<F>(xy.x, xy.y, z.cell + z.frac, w.cell + w.frac); }
+};
+
+template <typename F> requires SimdFloat<F>
+inline HybridVec4<F> operator*(const F& f, const HybridVec4<F>& p) {
+    return HybridVec4<F>{ p.xy * f, f * p.z, f * p.w };
+}
+
+//Cell & smoothed fractional position of p.  (As value_noise(vec4) computes from floor & fract)
+template <typename F> requires SimdFloat<F>
+inline std::array<vec4<F>, 2> hybrid_cell(const HybridVec4<F>& p) {
+    const vec2<F> i = floor(p.xy);
+    const vec4<F> f(p.xy.x - i.x, p.xy.y - i.y, p.z.frac, p.w.frac);
+    const vec4<F> u = f * f * (static_cast<F>(3.0) - (f + f));
+    return { vec4<F>(i.x, i.y, p.z.cell, p.w.cell), u };
+}
+
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline F value_noise(const HybridVec4<F>& p, uint32_t seed) {
+    const auto [i, u] = hybrid_cell(p);
+    return value_noise_interpolate(lattice_corner_hashes<lattice>(i, seed), u);
+}
+
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline F value_noise(const HybridVec4<F>& p, uint32_t seed, LatticeCache<F>& cache) {
+    const auto [i, u] = hybrid_cell(p);
+    return value_noise_interpolate(cache.template corner_hashes<lattice>(i, seed), u);
+}
+
+template <NoiseBasis basis, NoiseLattice lattice, typename F> requires SimdFloat<F>
+inline F basis_noise(const HybridVec4<F>& p, uint32_t seed, LatticeCache<F>* cache = nullptr) {
+    if constexpr (basis != NoiseBasis::simplex) {
+        if (cache) return value_noise<lattice>(p, seed, *cache);
+        if constexpr (basis == NoiseBasis::value_parallel_corners && std::same_as<F, FallbackFloat32>) {
+            const auto [i, u] = hybrid_cell(p);
+            return value_noise_interpolate(lattice_corner_hashes_parallel<lattice>(i, seed), u);
+        }
+        return value_noise<lattice>(p, seed);
+    }
+    else {
+        return simplex_noise(p.to_vec4(), seed);
+    }
+}
 
 /**************************************************************************************************
 Based on article by Inigo Quilez https://www.iquilezles.org/www/articles/fbm/fbm.htm
@@ -349,7 +1099,7 @@ inline F fbm(const F & x, int number_octaves = 8, uint32_t seed = 1) {
     return t;
 }
 
-template <typename F> requires SimdFloat<F> || std::floating_point<F>
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F> || std::floating_point<F>
 inline F fbm(const vec2<F>& x, int number_octaves = 8, uint32_t seed=1){
     const F G = exp2(-1.0f);
     
@@ -357,7 +1107,7 @@ inline F fbm(const vec2<F>& x, int number_octaves = 8, uint32_t seed=1){
     F a = 1.0;
     F t = 0.0;
     for (int i = 0; i < number_octaves; i++) {
-        t += a * value_noise(f * x, seed);
+        t += a * value_noise<lattice>(f * x, seed);
         f *= 2.0;
         a *= G;
     }
@@ -377,7 +1127,7 @@ inline F fbm(const vec3<F>& x, int number_octaves = 8, uint32_t seed = 0) {
     }
     return t;
 }
-template <typename F> requires SimdFloat<F> || std::floating_point<F>
+template <NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F> || std::floating_point<F>
 inline F fbm(const vec4<F>& x, int number_octaves = 8, uint32_t seed = 0) {
     const typename F::F H{ exp2( -1.0f)};
     F G = H;
@@ -385,10 +1135,336 @@ inline F fbm(const vec4<F>& x, int number_octaves = 8, uint32_t seed = 0) {
     F a = 1.0;
     F t = 0.0;
     for (int i = 0; i < number_octaves; i++) {
-        t += a * value_noise(f * x, seed);
+        t += a * value_noise<lattice>(f * x, seed);
+        f *= 2.0;
+        a *= G;
+    }
+    return t;
+}
+
+
+
+/**************************************************************************************************
+fbm of several inputs at once.
+Evaluates N independent fbm calls in one octave loop, so their hash/mix chains can be interleaved
+by the CPU.  Results match calling fbm() on each input separately.
+*************************************************************************************************/
+template <size_t N, NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec2<F>, N>& x, int number_octaves = 8, uint32_t seed = 1) {
+    const F G = exp2(-1.0f);
+
+    F f = 1.0;
+    F a = 1.0;
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    for (int i = 0; i < number_octaves; i++) {
+        for (size_t n = 0; n < N; n++) {
+            t[n] += a * value_noise<lattice>(f * x[n], seed);
+        }
         f *= 2.0;
         a *= G;
     }
     return t;
 }
 
+template <size_t N, NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec4<F>, N>& x, int number_octaves = 8, uint32_t seed = 0) {
+    const typename F::F H{ exp2(-1.0f) };
+    F G = H;
+    F f = 1.0;
+    F a = 1.0;
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    for (int i = 0; i < number_octaves; i++) {
+        for (size_t n = 0; n < N; n++) {
+            t[n] += a * value_noise<lattice>(f * x[n], seed);
+        }
+        f *= 2.0;
+        a *= G;
+    }
+    return t;
+}
+
+
+/**************************************************************************************************
+fbm with a compile time number of octaves.
+The octave loop is fully unrolled, with the frequency & amplitude of each octave as constants.
+Results match the runtime octave versions above. (Use those when the octave count is a parameter)
+*************************************************************************************************/
+template <typename T, int octave> inline constexpr T fbm_frequency = static_cast<T>(1ull << octave);
+template <typename T, int octave> inline constexpr T fbm_amplitude = static_cast<T>(1.0) / static_cast<T>(1ull << octave);
+
+//Adds a single octave to each of the N running totals.
+template <int octave, NoiseLattice lattice, NoiseBasis basis, typename F, typename V, size_t N> requires SimdFloat<F>
+inline void fbm_octave(std::array<F, N>& t, const std::array<V, N>& x, uint32_t seed) {
+    const F f(fbm_frequency<typename F::F, octave>);
+    const F a(fbm_amplitude<typename F::F, octave>);
+    for (size_t n = 0; n < N; n++) {
+        t[n] += a * basis_noise<basis, lattice>(f * x[n], seed);
+    }
+}
+
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec2<F>, N>& x, uint32_t seed = 1) {
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    [&]<int... octave>(std::integer_sequence<int, octave...>) {
+        (fbm_octave<octave, lattice, basis>(t, x, seed), ...);
+    }(std::make_integer_sequence<int, Octaves>{});
+    return t;
+}
+
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec4<F>, N>& x, uint32_t seed = 0) {
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    [&]<int... octave>(std::integer_sequence<int, octave...>) {
+        (fbm_octave<octave, lattice, basis>(t, x, seed), ...);
+    }(std::make_integer_sequence<int, Octaves>{});
+    return t;
+}
+
+template <int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline F fbm(const vec2<F>& x, uint32_t seed = 1) {
+    return fbm_multi<1, Octaves, lattice, basis>(std::array{ x }, seed)[0];
+}
+
+template <int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline F fbm(const vec4<F>& x, uint32_t seed = 0) {
+    return fbm_multi<1, Octaves, lattice, basis>(std::array{ x }, seed)[0];
+}
+
+
+/**************************************************************************************************
+Band-limited fbm (level of detail)
+
+Octaves finer than the pixel footprint only add aliasing (and cost).  FbmDetail describes how many
+octaves of an fbm are worth evaluating.
+Octaves beyond the limit are replaced by their mean value (0.5 * amplitude) so brightness is kept,
+and the last octave is faded towards its mean to avoid popping as the footprint changes.
+
+Build once per frame with make_fbm_detail().  At full detail the result is identical to fbm().
+*************************************************************************************************/
+template <SimdFloat F>
+struct FbmDetail {
+    int octaves{};          //Number of octaves to evaluate
+    F fade{ 1.0 };          //Weight of the last evaluated octave
+    F tail{ 0.0 };          //Mean contribution of the skipped & faded octaves
+    bool reduced{};         //False at full detail
+};
+
+/**************************************************************************************************
+    base_frequency: Lattice cells per unit of the input co-ordinate for the first octave.
+    footprint:      Size of one pixel in input co-ordinate units.
+*************************************************************************************************/
+template <int Octaves, SimdFloat F>
+inline FbmDetail<F> make_fbm_detail(double base_frequency, double footprint) {
+    //Weight of each octave.  Full detail at 4 pixels per lattice cell, fading out to nothing at 2 pixels (Nyquist).
+    std::array<double, Octaves> weight{};
+    for (int i = 0; i < Octaves; i++) {
+        const double cells_per_pixel = base_frequency * std::exp2(i) * std::abs(footprint);
+        weight[i] = std::clamp((0.5 - cells_per_pixel) / 0.25, 0.0, 1.0);
+    }
+
+    //Weights only decrease with octave, so only the last evaluated octave can be partially faded.
+    FbmDetail<F> detail{};
+    double fade = 1.0;
+    double tail = 0.0;
+    for (int i = 0; i < Octaves; i++) {
+        if (weight[i] > 0.0) {
+            detail.octaves = i + 1;
+            fade = weight[i];
+        }
+        tail += 0.5 * std::exp2(-i) * (1.0 - weight[i]);
+    }
+    detail.reduced = detail.octaves != Octaves || fade != 1.0;
+    detail.fade = F(static_cast<typename F::F>(fade));
+    detail.tail = F(static_cast<typename F::F>(tail));
+    return detail;
+}
+
+
+//Adds the last evaluated octave, faded by weight.
+template <int octave, NoiseLattice lattice, NoiseBasis basis, typename F, typename V, size_t N, typename Cache = LatticeCache<F>> requires SimdFloat<F>
+inline void fbm_octave(std::array<F, N>& t, const std::array<V, N>& x, uint32_t seed, const F& weight, Cache* cache = nullptr) {
+    const F f(fbm_frequency<typename F::F, octave>);
+    const F a = F(fbm_amplitude<typename F::F, octave>) * weight;
+    for (size_t n = 0; n < N; n++) {
+        t[n] += a * basis_noise<basis, lattice>(f * x[n], seed, cache);
+    }
+}
+
+//Adds a single octave, looking up the lattice in cache (a LatticeCache or LatticeTable, nullptr for none)
+template <int octave, NoiseLattice lattice, NoiseBasis basis, typename F, typename V, size_t N, typename Cache> requires SimdFloat<F>
+inline void fbm_octave(std::array<F, N>& t, const std::array<V, N>& x, uint32_t seed, Cache* cache) {
+    const F f(fbm_frequency<typename F::F, octave>);
+    const F a(fbm_amplitude<typename F::F, octave>);
+    for (size_t n = 0; n < N; n++) {
+        t[n] += a * basis_noise<basis, lattice>(f * x[n], seed, cache);
+    }
+}
+
+//Evaluates the octaves selected by detail. (The octave count check is the same for every pixel in a frame, so predicts well)
+//The first cached_octaves octaves look up their lattice in cache (if not nullptr).
+template <int Octaves, NoiseLattice lattice, NoiseBasis basis, typename F, typename V, size_t N, typename Cache = LatticeCache<F>> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi_detail(const std::array<V, N>& x, const FbmDetail<F>& detail, uint32_t seed, Cache* cache = nullptr, int cached_octaves = 0) {
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    [&]<int... octave>(std::integer_sequence<int, octave...>) {
+        ((octave < detail.octaves - 1 ? fbm_octave<octave, lattice, basis>(t, x, seed, octave < cached_octaves ? cache : nullptr)
+            : octave == detail.octaves - 1 ? fbm_octave<octave, lattice, basis>(t, x, seed, detail.fade, octave < cached_octaves ? cache : nullptr)
+            : void()), ...);
+    }(std::make_integer_sequence<int, Octaves>{});
+    if (detail.reduced) {
+        for (auto& v : t) v += detail.tail;
+    }
+    return t;
+}
+
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec2<F>, N>& x, const FbmDetail<F>& detail, uint32_t seed = 1) {
+    return fbm_multi_detail<Octaves, lattice, basis>(x, detail, seed);
+}
+
+//Looks up the lattice of every octave in table. (See LatticeTable.  nullptr to hash)
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec2<F>, N>& x, const FbmDetail<F>& detail, uint32_t seed, const LatticeTable* table) {
+    return fbm_multi_detail<Octaves, lattice, basis>(x, detail, seed, table, Octaves);
+}
+
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec4<F>, N>& x, const FbmDetail<F>& detail, uint32_t seed = 0) {
+    return fbm_multi_detail<Octaves, lattice, basis>(x, detail, seed);
+}
+
+//The first cached_octaves octaves look up their lattice in cache. (See LatticeCache.  Use for low frequency octaves only)
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<vec4<F>, N>& x, const FbmDetail<F>& detail, uint32_t seed, LatticeCache<F>& cache, int cached_octaves) {
+    return fbm_multi_detail<Octaves, lattice, basis>(x, detail, seed, &cache, cached_octaves);
+}
+
+//fbm of hybrid inputs.  The first cached_octaves octaves look up their lattice in cache (if not nullptr)
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, NoiseBasis basis = NoiseBasis::value, typename F> requires SimdFloat<F>
+inline std::array<F, N> fbm_multi(const std::array<HybridVec4<F>, N>& x, const FbmDetail<F>& detail, uint32_t seed, LatticeCache<F>* cache = nullptr, int cached_octaves = 0) {
+    return fbm_multi_detail<Octaves, lattice, basis>(x, detail, seed, cache, cached_octaves);
+}
+
+
+/**************************************************************************************************
+4D value noise on a constant z/w slice.
+
+When z & w are the same for every pixel of a frame (eg. evolve), the z/w half of the lattice can be
+done once per frame.  NoiseSlice holds a hash & smoothstep weight for each of the 4 z/w corners.
+Per pixel only the 4 x/y corners are hashed (as 2D value noise), and each 4D corner value is the
+x/y hash xor the z/w hash, remixed by one multiply.  So 4 full hashes per cell rather than 16, and
+no z/w floor, fract or interpolation.
+
+This is not the same hash as value_noise (4D), so gives a different (equally smooth) look.
+32-bit float types only.
+*************************************************************************************************/
+struct NoiseSlice {
+    std::array<uint32_t, 4> hash{};     //Hash of each z/w corner.  Corner index bits are: z = 1, w = 2.
+    std::array<float, 4> weight{};      //Interpolation weight of each z/w corner. (Sums to 1)
+};
+
+template <NoiseLattice lattice = NoiseLattice::float_bits>
+inline NoiseSlice make_noise_slice(float z, float w, uint32_t seed) {
+    using T = FallbackFloat32;
+    const T iz = floor(T(z));
+    const T iw = floor(T(w));
+    const T fz = T(z) - iz;
+    const T fw = T(w) - iw;
+    const float uz = (fz * fz * (3.0f - (fz + fz))).v;
+    const float uw = (fw * fw * (3.0f - (fw + fw))).v;
+
+    const auto bz = lattice_axis_bits<lattice>(iz);
+    const auto bw = lattice_axis_bits<lattice>(iw);
+    const FallbackUInt32 first(seed);
+
+    NoiseSlice slice;
+    for (int k = 0; k < 4; k++) {
+        const auto hz = hash_32_combine(hash_32_mix(bz[k & 1]), first);
+        const auto hzw = hash_32_combine(hash_32_mix(bw[k >> 1]), hz);
+        slice.hash[k] = hash_32_final(hash_32_final(hzw)).v;  //Fully mixed, as the per pixel remix is weak
+        slice.weight[k] = (k & 1 ? uz : 1.0f - uz) * (k & 2 ? uw : 1.0f - uw);
+    }
+    return slice;
+}
+
+template <NoiseLattice lattice = NoiseLattice::float_bits, SimdFloat32 F>
+inline F value_noise_slice(const vec2<F>& p, const NoiseSlice& slice, uint32_t seed) {
+    using U = typename F::U;
+    const vec2<F> i = floor(p);
+    const vec2<F> f = fract(p);
+    const vec2<F> u = f * f * (static_cast<typename F::F>(3.0) - (f + f));
+
+    //x/y corner hashes, as lattice_corner_hashes().  (Corner index bits are: x = 1, y = 2)
+    const auto bx = lattice_axis_bits<lattice>(i.x);
+    const auto by = lattice_axis_bits<lattice>(i.y);
+    const auto my0 = hash_32_mix(by[0]);
+    const auto my1 = hash_32_mix(by[1]);
+    const auto hx0 = hash_32_combine(hash_32_mix(bx[0]), seed);
+    const auto hx1 = hash_32_combine(hash_32_mix(bx[1]), seed);
+    const std::array<U, 4> h{
+        hash_32_final(hash_32_combine(my0, hx0)),
+        hash_32_final(hash_32_combine(my0, hx1)),
+        hash_32_final(hash_32_combine(my1, hx0)),
+        hash_32_final(hash_32_combine(my1, hx1)),
+    };
+
+    //Blend the z/w corners into each x/y corner.  (Top 23 bits of the remix, as hash_32_to_float)
+    std::array<F, 4> corner{ F(0.0), F(0.0), F(0.0), F(0.0) };
+    for (int k = 0; k < 4; k++) {
+        const U zw(slice.hash[k]);
+        const F weight(slice.weight[k]);
+        for (int c = 0; c < 4; c++) {
+            corner[c] = fma(weight, F::make_from_int32(((h[c] ^ zw) * U(0x9E3779B1)) >> 9), corner[c]);
+        }
+    }
+
+    //Scale to 0..1 once, rather than per hash.
+    const F y1 = mix(corner[0], corner[1], u.x);
+    const F y2 = mix(corner[2], corner[3], u.x);
+    return mix(y1, y2, u.y) * F(1.0f / static_cast<float>(0xffffffff >> 9));
+}
+
+
+/**************************************************************************************************
+fbm on constant z/w slices.
+make_fbm_slices() builds the slice of each octave (octave k is at frequency 2^k, as fbm_multi).
+fbm_multi_slice() matches fbm_multi(vec4) with the z/w of input n held in slices[n].
+*************************************************************************************************/
+template <int Octaves, NoiseLattice lattice = NoiseLattice::float_bits>
+inline std::array<NoiseSlice, Octaves> make_fbm_slices(float z, float w, uint32_t seed) {
+    std::array<NoiseSlice, Octaves> slices;
+    for (int octave = 0; octave < Octaves; octave++) {
+        const auto f = static_cast<float>(1ull << octave);
+        slices[octave] = make_noise_slice<lattice>(f * z, f * w, seed);
+    }
+    return slices;
+}
+
+//Adds a single octave on the slices, faded by weight.
+template <int octave, NoiseLattice lattice, typename F, size_t N, size_t Octaves> requires SimdFloat32<F>
+inline void fbm_slice_octave(std::array<F, N>& t, const std::array<vec2<F>, N>& x, const std::array<std::array<NoiseSlice, Octaves>, N>& slices, uint32_t seed, const F& weight) {
+    const F f(fbm_frequency<typename F::F, octave>);
+    const F a = F(fbm_amplitude<typename F::F, octave>) * weight;
+    for (size_t n = 0; n < N; n++) {
+        t[n] += a * value_noise_slice<lattice>(f * x[n], slices[n][octave], seed);
+    }
+}
+
+template <size_t N, int Octaves, NoiseLattice lattice = NoiseLattice::float_bits, typename F> requires SimdFloat32<F>
+inline std::array<F, N> fbm_multi_slice(const std::array<vec2<F>, N>& x, const std::array<std::array<NoiseSlice, Octaves>, N>& slices, const FbmDetail<F>& detail, uint32_t seed) {
+    std::array<F, N> t;
+    t.fill(F(0.0));
+    [&]<int... octave>(std::integer_sequence<int, octave...>) {
+        ((octave < detail.octaves - 1 ? fbm_slice_octave<octave, lattice>(t, x, slices, seed, F(1.0))
+            : octave == detail.octaves - 1 ? fbm_slice_octave<octave, lattice>(t, x, slices, seed, detail.fade)
+            : void()), ...);
+    }(std::make_integer_sequence<int, Octaves>{});
+    if (detail.reduced) {
+        for (auto& v : t) v += detail.tail;
+    }
+    return t;
+}
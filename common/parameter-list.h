@@ -25,6 +25,10 @@ Description:
 
 	Tools to build a host independant parameter list.
 
+	The parameters are described once (ParameterDefinitions: names, types, ranges & defaults) and the
+	definitions are shared by every ParameterList.  A ParameterList only owns the values for one frame,
+	so copying one for a render is cheap.  Values are looked up through a dense array indexed by ParameterID.
+
 *********************************************************************************************************/
 #pragma once
 
@@ -32,6 +36,10 @@ Description:
 #include "parameter-id.h"
 #include "../common/colour.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -55,6 +63,7 @@ enum class ParameterType {
 
 /*********************************************************************************************************
 A Parameter Entry
+The description of a parameter.  (Values for a frame are in ParameterValue)
 *********************************************************************************************************/
 struct ParameterEntry {
 	ParameterID id{};
@@ -67,9 +76,6 @@ struct ParameterEntry {
 	double slider_min{};
 	double slider_max{};
 	short precision{};
-	double value{};
-	int value_integer{};
-	std::string value_string {};
 	std::vector<std::string> list {};
 	float red{};
 	float green{};
@@ -85,7 +91,6 @@ struct ParameterEntry {
 		p.max = static_cast<double>(std::numeric_limits<uint32_t>::max());
 		p.slider_min = p.min;
 		p.slider_max = p.max;
-		p.value = p.initial_value;
 		return p;
 	}
 
@@ -100,7 +105,6 @@ struct ParameterEntry {
 		p.slider_min = slider_minimum;
 		p.slider_max = slider_maximum;
 		p.precision = decimals;
-		p.value = p.initial_value;
 		return p;
 	}	
 
@@ -142,77 +146,141 @@ struct ParameterEntry {
 
 
 /*********************************************************************************************************
-A List of parameters.
-Simply a std::vector wrapped in a struct with helper functions.
+The value of a parameter for one frame.
+List values are stored as the index of the selected item.
 *********************************************************************************************************/
-struct ParameterList {
+struct ParameterValue {
+	double value{};
+	int value_integer{};	//Seeds, and the selected index of lists
+	float red{};
+	float green{};
+	float blue{};
+
+	static ParameterValue make_initial(const ParameterEntry& e) {
+		return ParameterValue{ e.initial_value, 0, e.red, e.green, e.blue };
+	}
+};
+
+
+/*********************************************************************************************************
+The definitions of a project's parameters, in host display order.
+Build once with add_entry(), then share (as const) with every ParameterList.
+*********************************************************************************************************/
+struct ParameterDefinitions {
+	static constexpr int id_count = parameter_id_to_int(ParameterID::__last);
+
 	std::vector<ParameterEntry> entries{};
+	std::array<int16_t, id_count> slots{};	//Index into entries for each ParameterID (-1 if not used)
+
+	ParameterDefinitions() noexcept { slots.fill(-1); }
 
 	//Add a new entry
 	void add_entry(ParameterEntry entry) {
-		entries.push_back(entry);
+		slots.at(parameter_id_to_int(entry.id)) = static_cast<int16_t>(entries.size());
+		entries.push_back(std::move(entry));
 	}
 
-	//Get a value (as a double float)
-	bool contains(ParameterID id) const {
-		for (const auto& e : entries) {
-			if (id == e.id) return true;
-		}
-		return false;
+	//Index of a parameter in entries (-1 if not found)
+	int slot(ParameterID id) const noexcept {
+		const int i = parameter_id_to_int(id);
+		return (i >= 0 && i < id_count) ? slots[i] : -1;
+	}
+};
+
+
+/*********************************************************************************************************
+A List of parameters.
+The shared definitions, plus the values for one frame (values[i] is the value of entries()[i]).
+*********************************************************************************************************/
+struct ParameterList {
+	std::shared_ptr<const ParameterDefinitions> definitions{};
+	std::vector<ParameterValue> values{};
+
+	ParameterList() = default;
+
+	//A list with the initial values
+	explicit ParameterList(std::shared_ptr<const ParameterDefinitions> d) : definitions(std::move(d)) {
+		values.reserve(definitions->entries.size());
+		for (const auto& e : definitions->entries) values.push_back(ParameterValue::make_initial(e));
+	}
+
+	//Parameter descriptions
+	const std::vector<ParameterEntry>& entries() const noexcept {
+		static const std::vector<ParameterEntry> none{};
+		return definitions ? definitions->entries : none;
+	}
+
+	//Is the parameter in the list
+	bool contains(ParameterID id) const noexcept {
+		return find(id) != nullptr;
 	}
 
 	//Get a value (as a double float)
-	double get_value(ParameterID id) const  {
-		for (const auto & e : entries) {
-			if (id == e.id) return e.value;
-		}
-		return 0.0;
+	double get_value(ParameterID id) const noexcept {
+		const auto v = find(id);
+		return v ? v->value : 0.0;
 	}
 	//Get a value (as a single float)
-	float get_valuef(ParameterID id) const {
-		for (const auto& e : entries) {
-			if (id == e.id) return static_cast<float>(e.value);
-		}
-		return 0.0f;
+	float get_valuef(ParameterID id) const noexcept {
+		const auto v = find(id);
+		return v ? static_cast<float>(v->value) : 0.0f;
 	}
 
-	//Get a value (as an integer)
-	int get_value_integer(ParameterID id) const {
-		for (const auto& e : entries) {
-			if (id == e.id) return e.value_integer;
-		}
-		return 0;
+	//Get a value (as an integer).  For lists, this is the index of the selected item.
+	int get_value_integer(ParameterID id) const noexcept {
+		const auto v = find(id);
+		return v ? v->value_integer : 0;
 	}
 
-	//Get a value (as a string)
+	//Get the selected item of a list (as a string)
 	std::string get_string(ParameterID id) const {
-		for (const auto & e : entries) {
-			if (id == e.id) return e.value_string;
-		}
-		return std::string();
+		const auto v = find(id);
+		if (!v) return std::string();
+		const auto& list = definitions->entries[definitions->slot(id)].list;
+		return (v->value_integer >= 0 && v->value_integer < static_cast<int>(list.size())) ? list[v->value_integer] : std::string();
+	}
+
+	ColourRGBA<float> get_colour(ParameterID id) const {
+		const auto v = find(id);
+		if (!v) throw(std::runtime_error("Parameter not found."));
+		return ColourRGBA<float>(v->red, v->green, v->blue);
 	}
 
 	//Set a numerical value
-	double set_value(ParameterID id, double v) {
-		for (auto & e : entries) {
-			if (id == e.id) e.value = v;
-		}
-		throw(std::runtime_error("Parameter not found."));
+	void set_value(ParameterID id, double v) {
+		at(id).value = v;
 	}
 
-	//Set a string value
-	double set_value_string(ParameterID id, std::string v) {
-		for (auto & e : entries) {
-			if (id == e.id) e.value_string = v;
-		}
-		throw(std::runtime_error("Parameter not found."));
+	//Set an integer value (for lists, the index of the selected item)
+	void set_value_integer(ParameterID id, int v) {
+		at(id).value_integer = v;
 	}
 
-	ColourRGBA<float> get_colour(ParameterID id) const {
-		for (auto& e : entries) {
-			if (id == e.id) return ColourRGBA<float>(e.red,e.green,e.blue);
-		}
-		throw(std::runtime_error("Parameter not found."));
+	//Select a list item by its string
+	void set_value_string(ParameterID id, const std::string& v) {
+		auto& value = at(id);
+		const auto& list = definitions->entries[definitions->slot(id)].list;
+		const auto found = std::find(list.begin(), list.end(), v);
+		if (found == list.end()) throw(std::runtime_error("List item not found."));
+		value.value_integer = static_cast<int>(found - list.begin());
+	}
+
+	//Set a colour value
+	void set_colour(ParameterID id, float r, float g, float b) {
+		auto& v = at(id);
+		v.red = r;
+		v.green = g;
+		v.blue = b;
 	}
 
+private:
+	const ParameterValue* find(ParameterID id) const noexcept {
+		const int i = definitions ? definitions->slot(id) : -1;
+		return i >= 0 ? &values[i] : nullptr;
+	}
+	ParameterValue& at(ParameterID id) {
+		const int i = definitions ? definitions->slot(id) : -1;
+		if (i < 0) throw(std::runtime_error("Parameter not found."));
+		return values[i];
+	}
 };
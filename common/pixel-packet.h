@@ -0,0 +1,87 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+	Lane layout of a SIMD packet of pixels.
+
+	A packet is a block of columns x rows pixels, one pixel per lane.
+	Lane i is the pixel (x + i % columns, y + i / columns), where (x, y) is the top left pixel.
+
+	Rows = 1 is a single scan line (S::make_sequential(x) with a broadcast y).
+	Square layouts (2x2 SSE, 4x2 AVX2, 4x4 AVX-512) keep the lanes closer together after domain warping,
+	so more packets fall inside a single noise lattice cell.
+
+********************************************************************************************************/
+#pragma once
+
+#include <array>
+
+#include "simd-concepts.h"
+
+
+/**************************************************************************************************
+Number of rows for the squarest packet of S.  (Never taller than wide)
+1 lane: 1x1, 4 lanes: 2x2, 8 lanes: 4x2, 16 lanes: 4x4
+*************************************************************************************************/
+template <SimdFloat S>
+constexpr int square_packet_rows() {
+	int rows = 1;
+	while (rows * rows * 4 <= S::number_of_elements()) rows *= 2;
+	return rows;
+}
+
+
+/**************************************************************************************************
+A packet layout with Rows scan lines.
+*************************************************************************************************/
+template <SimdFloat S, int Rows = 1>
+struct PixelPacket {
+	static_assert(Rows > 0 && S::number_of_elements() % Rows == 0, "Rows must divide the number of SIMD lanes");
+
+	static constexpr int rows = Rows;
+	static constexpr int columns = S::number_of_elements() / Rows;
+
+	//Position of a lane within the packet
+	static constexpr int lane_x(int lane) noexcept { return lane % columns; }
+	static constexpr int lane_y(int lane) noexcept { return lane / columns; }
+
+	//Pixel x co-ordinate of each lane, for the packet with top left pixel (x, y)
+	static S x(int x) noexcept {
+		if constexpr (rows == 1) return S::make_sequential(static_cast<typename S::F>(x));
+		else return S(static_cast<typename S::F>(x)) + offsets()[0];
+	}
+
+	//Pixel y co-ordinate of each lane, for the packet with top left pixel (x, y)
+	static S y(int y) noexcept {
+		if constexpr (rows == 1) return S(static_cast<typename S::F>(y));
+		else return S(static_cast<typename S::F>(y)) + offsets()[1];
+	}
+
+private:
+	//Lane offsets (x, y) from the top left pixel.  (Exact, as they are small integers)
+	static std::array<S, 2> offsets() noexcept {
+		const S lane = S::make_sequential(static_cast<typename S::F>(0));
+		const S row = floor((lane + static_cast<typename S::F>(0.5)) * static_cast<typename S::F>(1.0 / columns));
+		return { lane - row * static_cast<typename S::F>(columns), row };
+	}
+};
@@ -68,14 +68,45 @@ I've included FallbackFloat32 for use with Emscripen, but use SimdNativeFloat32
 *********************************************************************************************************/
 
 
+#include <bit>
 #include <cmath>
 
 #include "environment.h"
 #include "simd-cpuid.h"
 #include "simd-concepts.h"
 #include "simd-uint32.h"
+#include "simd-int32.h"
 #include "simd-uint64.h"
 
+/***************************************************************************************************************************************************************************************************
+ * Half precision (IEEE binary16) conversion of a single float.  Rounds to nearest even, like F16C.
+ * Used by FallbackFloat32, and by the other types when the compiler doesn't target F16C.
+ * *************************************************************************************************************************************************************************************************/
+inline static uint16_t float_to_half(float f) noexcept {
+	const uint32_t x = std::bit_cast<uint32_t>(f);
+	const uint32_t sign = (x >> 16) & 0x8000;
+	const uint32_t abs = x & 0x7fffffff;
+	if (abs >= 0x7f800000) return static_cast<uint16_t>(sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0));	//Infinity & NaN
+	if (abs >= 0x477ff000) return static_cast<uint16_t>(sign | 0x7c00);									//Rounds above 65504 to infinity
+	if (abs < 0x38800000) {
+		//Subnormal.  (Scaling by 2^24 is exact, and 1024 rounds up to the smallest normal)
+		return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(std::bit_cast<float>(abs) * 16777216.0f)));
+	}
+	const uint32_t rounded = abs + 0xfff + ((abs >> 13) & 1);
+	return static_cast<uint16_t>(sign | ((rounded - 0x38000000) >> 13));
+}
+
+inline static float half_to_float(uint16_t h) noexcept {
+	const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+	const uint32_t exponent = (h >> 10) & 0x1f;
+	const uint32_t mantissa = h & 0x3ff;
+	if (exponent == 0) return std::bit_cast<float>(sign | std::bit_cast<uint32_t>(static_cast<float>(mantissa) * 5.9604645e-8f));	//Subnormal (mantissa * 2^-24)
+	if (exponent == 31) return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+	return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+
+
 /***************************************************************************************************************************************************************************************************
  * Fallback to a single 32 bit float
  * *************************************************************************************************************************************************************************************************/
@@ -152,6 +183,14 @@ struct FallbackFloat32 {
 	//*****Cast Functions****
 	FallbackUInt32 bitcast_to_uint() const noexcept { return FallbackUInt32(std::bit_cast<uint32_t>(this->v)); }
 
+	//Converts to signed int32, rounding towards zero.  (Values outside the int32 range are undefined)
+	FallbackInt32 truncate_to_int32() const noexcept { return FallbackInt32(static_cast<int32_t>(this->v)); }
+
+	//*****Half Precision*****
+	//Stores number_of_elements() half floats to p, or loads them from p.  (Rounds to nearest even)
+	void store_half(uint16_t* p) const noexcept { *p = float_to_half(v); }
+	static FallbackFloat32 load_half(const uint16_t* p) noexcept { return FallbackFloat32(half_to_float(*p)); }
+
 	
 
 };
@@ -241,6 +280,15 @@ inline static FallbackFloat32 clamp(const FallbackFloat32 a, const float min_f,
 
 
 
+//*****Horizontal Functions*****
+inline static float reduce_min(FallbackFloat32 a) noexcept { return a.v; }
+inline static float reduce_max(FallbackFloat32 a) noexcept { return a.v; }
+inline static bool is_uniform(FallbackFloat32 a) noexcept { return a.v == a.v; }
+
+//*****Gather*****
+//Loads table[index] for each element.
+inline static FallbackFloat32 gather(const float* table, const FallbackUInt32& index) { return FallbackFloat32(table[index.v]); }
+
 //*****Approximate Functions*****
 inline static FallbackFloat32 reciprocal_approx(FallbackFloat32 a) noexcept { return FallbackFloat32(1.0f / a.v); }
 
@@ -393,6 +441,14 @@ struct Simd512Float32 {
 
 	//Converts to an unsigned integer.  No check is performed to see if that type is supported. Use cpu_level_supported() for safety. 
 	Simd512UInt32 bitcast_to_uint() const { return Simd512UInt32(_mm512_castps_si512(this->v)); }
+
+	//Converts to signed int32, rounding towards zero.  (Values outside the int32 range are undefined)
+	Simd512Int32 truncate_to_int32() const noexcept { return Simd512Int32(_mm512_cvttps_epi32(this->v)); }
+
+	//*****Half Precision*****
+	//Stores number_of_elements() half floats to p, or loads them from p.  (Rounds to nearest even)
+	void store_half(uint16_t* p) const noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT)); }
+	static Simd512Float32 load_half(const uint16_t* p) noexcept { return Simd512Float32(_mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)))); }
 	
 
 	
@@ -489,6 +545,24 @@ inline static Simd512Float32 clamp(const Simd512Float32 a, const float min_f, co
 
 
 
+//*****Horizontal Functions*****
+[[nodiscard("Value calculated and not used (reduce_min)")]]
+inline static float reduce_min(const Simd512Float32 a) noexcept { return _mm512_reduce_min_ps(a.v); }
+
+[[nodiscard("Value calculated and not used (reduce_max)")]]
+inline static float reduce_max(const Simd512Float32 a) noexcept { return _mm512_reduce_max_ps(a.v); }
+
+//True if every element holds the same value (0.0 and -0.0 count as equal, false if any element is NaN)
+[[nodiscard("Value calculated and not used (is_uniform)")]]
+inline static bool is_uniform(const Simd512Float32 a) noexcept {
+	const auto first = _mm512_broadcastss_ps(_mm512_castps512_ps128(a.v));
+	return _mm512_cmp_ps_mask(a.v, first, _CMP_EQ_OQ) == 0xFFFF;
+}
+
+//*****Gather*****
+//Loads table[index] for each element.
+inline static Simd512Float32 gather(const float* table, const Simd512UInt32& index) { return Simd512Float32(_mm512_i32gather_ps(index.v, table, 4)); }
+
 //*****Approximate Functions*****
 [[nodiscard("Value calculated and not used ()")]]
 inline static Simd512Float32 reciprocal_approx(Simd512Float32 a) noexcept { return Simd512Float32(_mm512_rcp14_ps(a.v)); }
@@ -652,7 +726,7 @@ struct Simd256Float32 {
 	}
 	//Performs a runtime CPU check to see if this type is supported.  Checks this type ONLY (integers in same the same level may not be supported) 
 	static bool cpu_supported(CpuInformation cpuid) {
-		return cpuid.has_avx() && cpuid.has_fma();
+		return cpuid.has_avx() && cpuid.has_fma() && cpuid.has_f16c();	//F16C for the half precision conversions
 	}
 
 	//Performs a compile time support. Checks this type ONLY (integers in same class may not be supported) 
@@ -668,7 +742,7 @@ struct Simd256Float32 {
 
 	//Performs a runtime CPU check to see if this type's microarchitecture level is supported.  (This will ensure that referernced integer types are also supported)
 	static bool cpu_level_supported(CpuInformation cpuid) {
-		return cpuid.has_avx2() && cpuid.has_avx() && cpuid.has_fma();
+		return cpuid.has_avx2() && cpuid.has_avx() && cpuid.has_fma() && cpuid.has_f16c();
 	}
 
 	//Performs a compile time support to see if the microarchitecture level is supported.  (This will ensure that referernced integer types are also supported)
@@ -714,6 +788,28 @@ struct Simd256Float32 {
 	
 	//Warning: Requires additional CPU features (AVX2)
 	Simd256UInt32 bitcast_to_uint() const { return Simd256UInt32(_mm256_castps_si256(this->v)); } 
+
+	//Converts to signed int32, rounding towards zero.  (Values outside the int32 range are undefined)
+	Simd256Int32 truncate_to_int32() const noexcept { return Simd256Int32(_mm256_cvttps_epi32(this->v)); }
+
+	//*****Half Precision*****
+	//Stores number_of_elements() half floats to p, or loads them from p.  (Rounds to nearest even)
+	void store_half(uint16_t* p) const noexcept {
+		if constexpr (mt::environment::compiler_has_f16c) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));	//F16C
+		}
+		else {
+			for (int i = 0; i < number_of_elements(); i++) p[i] = float_to_half(element(i));
+		}
+	}
+	static Simd256Float32 load_half(const uint16_t* p) noexcept {
+		if constexpr (mt::environment::compiler_has_f16c) {
+			return Simd256Float32(_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));	//F16C
+		}
+		else {
+			return Simd256Float32(_mm256_set_ps(half_to_float(p[7]), half_to_float(p[6]), half_to_float(p[5]), half_to_float(p[4]), half_to_float(p[3]), half_to_float(p[2]), half_to_float(p[1]), half_to_float(p[0])));
+		}
+	}
 	
 
 	
@@ -815,6 +911,32 @@ inline static Simd256Float32 clamp(const Simd256Float32 a, const float min_f, co
 
 
 
+//*****Horizontal Functions*****
+[[nodiscard("Value calculated and not used (reduce_min)")]]
+inline static float reduce_min(const Simd256Float32 a) noexcept {
+	auto m = _mm_min_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+	m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+	return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+[[nodiscard("Value calculated and not used (reduce_max)")]]
+inline static float reduce_max(const Simd256Float32 a) noexcept {
+	auto m = _mm_max_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+	m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+	return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+//True if every element holds the same value (0.0 and -0.0 count as equal, false if any element is NaN)
+[[nodiscard("Value calculated and not used (is_uniform)")]]
+inline static bool is_uniform(const Simd256Float32 a) noexcept {
+	const auto first = _mm256_broadcastss_ps(_mm256_castps256_ps128(a.v));	//AVX2
+	return _mm256_movemask_ps(_mm256_cmp_ps(a.v, first, _CMP_EQ_OQ)) == 0xFF;
+}
+
+//*****Gather*****
+//Loads table[index] for each element.
+inline static Simd256Float32 gather(const float* table, const Simd256UInt32& index) { return Simd256Float32(_mm256_i32gather_ps(table, index.v, 4)); }	//AVX2
+
 //*****Approximate Functions*****
 [[nodiscard("Value calculated and not used (reciprocal_approx)")]]
 inline static Simd256Float32 reciprocal_approx(const Simd256Float32 a) noexcept {return Simd256Float32(_mm256_rcp_ps(a.v));}
@@ -1032,6 +1154,28 @@ struct Simd128Float32 {
 
 	//*****Cast Functions****
 	Simd128UInt32 bitcast_to_uint() const { return Simd128UInt32(_mm_castps_si128(this->v)); } //SSE2
+
+	//Converts to signed int32, rounding towards zero.  (Values outside the int32 range are undefined)
+	Simd128Int32 truncate_to_int32() const noexcept { return Simd128Int32(_mm_cvttps_epi32(this->v)); } //SSE2
+
+	//*****Half Precision*****
+	//Stores number_of_elements() half floats to p, or loads them from p.  (Rounds to nearest even)
+	void store_half(uint16_t* p) const noexcept {
+		if constexpr (mt::environment::compiler_has_f16c) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));	//F16C
+		}
+		else {
+			for (int i = 0; i < number_of_elements(); i++) p[i] = float_to_half(element(i));
+		}
+	}
+	static Simd128Float32 load_half(const uint16_t* p) noexcept {
+		if constexpr (mt::environment::compiler_has_f16c) {
+			return Simd128Float32(_mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));	//F16C
+		}
+		else {
+			return Simd128Float32(_mm_set_ps(half_to_float(p[3]), half_to_float(p[2]), half_to_float(p[1]), half_to_float(p[0])));
+		}
+	}
 	
 
 	
@@ -1176,6 +1320,37 @@ inline static Simd128Float32 clamp(const Simd128Float32 a, const float min_f, co
 
 
 
+//*****Horizontal Functions*****
+[[nodiscard("Value calculated and not used (reduce_min)")]]
+inline static float reduce_min(const Simd128Float32 a) noexcept {
+	const auto m = _mm_min_ps(a.v, _mm_movehl_ps(a.v, a.v));			//SSE1
+	return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+[[nodiscard("Value calculated and not used (reduce_max)")]]
+inline static float reduce_max(const Simd128Float32 a) noexcept {
+	const auto m = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));			//SSE1
+	return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+//True if every element holds the same value (0.0 and -0.0 count as equal, false if any element is NaN)
+[[nodiscard("Value calculated and not used (is_uniform)")]]
+inline static bool is_uniform(const Simd128Float32 a) noexcept {
+	return _mm_movemask_ps(_mm_cmpeq_ps(a.v, _mm_shuffle_ps(a.v, a.v, 0))) == 0xF;	//SSE1
+}
+
+//*****Gather*****
+//Loads table[index] for each element.
+inline static Simd128Float32 gather(const float* table, const Simd128UInt32& index) {
+	if constexpr (mt::environment::compiler_has_avx2) {
+		return Simd128Float32(_mm_i32gather_ps(table, index.v, 4)); //AVX2
+	}
+	else {
+		//No gather before AVX2 so we will just unroll.
+		return Simd128Float32(_mm_set_ps(table[index.v.m128i_u32[3]], table[index.v.m128i_u32[2]], table[index.v.m128i_u32[1]], table[index.v.m128i_u32[0]]));
+	}
+}
+
 //*****Approximate Functions*****
 [[nodiscard("Value calculated and not used (reciprocal_approx)")]]
 inline static Simd128Float32 reciprocal_approx(const Simd128Float32 a) noexcept { return Simd128Float32(_mm_rcp_ps(a.v)); } //sse
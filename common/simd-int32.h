@@ -71,6 +71,7 @@ I've included FallbackFloat32 for use with Emscripen, but use SimdNativeFloat32
 #include <stdint.h>
 #include "simd-cpuid.h"
 #include "simd-concepts.h"
+#include "simd-uint32.h"
 
 /**************************************************************************************************
 * Fallback Int32 type.
@@ -124,6 +125,9 @@ struct FallbackInt32 {
 	//*****Make Functions****
 	static FallbackInt32 make_sequential(int32_t first) { return FallbackInt32(first); }
 
+	//*****Cast Functions****
+	FallbackUInt32 bitcast_to_uint() const noexcept { return FallbackUInt32(static_cast<uint32_t>(v)); }
+
 
 	//*****Addition Operators*****
 	FallbackInt32& operator+=(const FallbackInt32& rhs) noexcept { v += rhs.v; return *this; }
@@ -254,6 +258,9 @@ struct Simd512Int32 {
 	//*****Make Functions****
 	static Simd512Int32 make_sequential(int32_t first) { return Simd512Int32(_mm512_set_epi32(first + 15, first + 14, first + 13, first + 12, first + 11, first + 10, first + 9, first + 8, first + 7, first + 6, first + 5, first + 4, first + 3, first + 2, first + 1, first)); }
 
+	//*****Cast Functions****
+	Simd512UInt32 bitcast_to_uint() const noexcept { return Simd512UInt32(v); }
+
 
 	//*****Addition Operators*****
 	Simd512Int32& operator+=(const Simd512Int32& rhs) noexcept { v = _mm512_add_epi32(v, rhs.v); return *this; }
@@ -455,6 +462,9 @@ struct Simd256Int32 {
 	//*****Make Functions****
 	static Simd256Int32 make_sequential(int32_t first) { return Simd256Int32(_mm256_set_epi32(first + 7, first + 6, first + 5, first + 4, first + 3, first + 2, first + 1, first)); }
 
+	//*****Cast Functions****
+	Simd256UInt32 bitcast_to_uint() const noexcept { return Simd256UInt32(v); }
+
 
 };
 
@@ -594,6 +604,9 @@ struct Simd128Int32 {
 	//*****Make Functions****
 	static Simd128Int32 make_sequential(int32_t first) { return Simd128Int32(_mm_set_epi32(first + 3, first + 2, first + 1, first)); }
 
+	//*****Cast Functions****
+	Simd128UInt32 bitcast_to_uint() const noexcept { return Simd128UInt32(v); }
+
 
 
 
@@ -191,6 +191,10 @@ inline static FallbackUInt64 rotr(const FallbackUInt64& a, int bits) { return a
 inline static FallbackUInt64 min(FallbackUInt64 a, FallbackUInt64 b) { return FallbackUInt64(std::min(a.v, b.v)); }
 inline static FallbackUInt64 max(FallbackUInt64 a, FallbackUInt64 b) { return FallbackUInt64(std::max(a.v, b.v)); }
 
+//*****32-bit Multiply*****
+//Multiplies the low 32 bits of each element, giving the full 64-bit product.  (Fast without AVX-512DQ, unlike operator*)
+inline static FallbackUInt64 multiply_low_32(const FallbackUInt64& a, const FallbackUInt64& b) { return FallbackUInt64((a.v & 0xFFFFFFFF) * (b.v & 0xFFFFFFFF)); }
+
 
 
 //***************** x86_64 only code ******************
@@ -318,6 +322,10 @@ inline static Simd512UInt64 rotr(const Simd512UInt64& a, const int bits) noexcep
 inline static Simd512UInt64 min(Simd512UInt64 a, Simd512UInt64 b) { return Simd512UInt64(_mm512_min_epu64(a.v, b.v)); }
 inline static Simd512UInt64 max(Simd512UInt64 a, Simd512UInt64 b) { return Simd512UInt64(_mm512_max_epu64(a.v, b.v)); }
 
+//*****32-bit Multiply*****
+//Multiplies the low 32 bits of each element, giving the full 64-bit product.  (Fast without AVX-512DQ, unlike operator*)
+inline static Simd512UInt64 multiply_low_32(const Simd512UInt64& a, const Simd512UInt64& b) noexcept { return Simd512UInt64(_mm512_mul_epu32(a.v, b.v)); }
+
 
 
 /**************************************************************************************************
@@ -460,6 +468,10 @@ inline static Simd256UInt64 rotr(const Simd256UInt64& a, int bits) {return a >>
 inline static Simd256UInt64 min(Simd256UInt64 a, Simd256UInt64 b) noexcept { return Simd256UInt64(_mm256_min_epu64(a.v, b.v)); }
 inline static Simd256UInt64 max(Simd256UInt64 a, Simd256UInt64 b) noexcept { return Simd256UInt64(_mm256_max_epu64(a.v, b.v)); }
 
+//*****32-bit Multiply*****
+//Multiplies the low 32 bits of each element, giving the full 64-bit product.  (Fast without AVX-512DQ, unlike operator*)
+inline static Simd256UInt64 multiply_low_32(const Simd256UInt64& a, const Simd256UInt64& b) noexcept { return Simd256UInt64(_mm256_mul_epu32(a.v, b.v)); }
+
 
 
 
@@ -649,6 +661,10 @@ inline static Simd128UInt64 max(Simd128UInt64 a, Simd128UInt64 b) noexcept {
 	}
 }
 
+//*****32-bit Multiply*****
+//Multiplies the low 32 bits of each element, giving the full 64-bit product.  (Fast without AVX-512DQ, unlike operator*)
+inline static Simd128UInt64 multiply_low_32(const Simd128UInt64& a, const Simd128UInt64& b) noexcept { return Simd128UInt64(_mm_mul_epu32(a.v, b.v)); } //sse2
+
 
 #endif //x86_64
 
@@ -225,7 +225,7 @@ static void after_effects_parameter_setup(PF_OutData* out_data) {
 	auto params = build_project_parameters();
 
 	//Build After Effect Parameters
-	for (auto p : params.entries) {
+	for (const auto& p : params.entries()) {
 		switch (p.type) {
 		case ParameterType::seed:
 			ParameterHelper::AddSlider(p.id, p.name, static_cast<float>(p.min), static_cast<float>(p.max), static_cast<float>(p.slider_min), static_cast<float>(p.slider_max), static_cast<float>(p.initial_value), 0);
@@ -40,6 +40,10 @@ Description:
 #include "..\..\common\simd-cpuid.h"
 #include "..\..\common\simd-f32.h"
 #include "..\..\common\simd-uint32.h"
+#include "..\..\common\pixel-packet.h"
+
+#include <algorithm>
+#include <vector>
 
 template <SimdFloat S>
 struct RenderData {
@@ -57,17 +61,17 @@ constexpr unsigned short adobe_white16 = 0x8000;
 
 /*******************************************************************************************************
 Copies a value to the output buffer. (32-bit components)
-Note: If we are using SIMD the value may contain multiple pixels.
+Note: If we are using SIMD the value may contain multiple pixels, laid out as packet P. (x, y is the top left pixel)
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 void copy_to_output_32(PF_EffectWorld* output, int x, int y, int max_x, const ColourRGBA<S>& c) {
-	//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)  
-	auto ptrY = (uint8_t*)output->data;
-	ptrY += y * output->rowbytes;
-
 	for (int i = 0; i < S::number_of_elements(); i++) {
-		if (x + i >= max_x) break;
-		auto ptrByte = ptrY + (x + i) * 4 * sizeof(float);  //Advance to x location.
+		if (x + P::lane_x(i) >= max_x) continue;
+
+		//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)  
+		auto ptrY = (uint8_t*)output->data;
+		ptrY += (y + P::lane_y(i)) * output->rowbytes;
+		auto ptrByte = ptrY + (x + P::lane_x(i)) * 4 * sizeof(float);  //Advance to x location.
 
 		auto ptrFloat = (float*)ptrByte;
 		ptrFloat[0] = static_cast<float>(c.alpha.element(i));
@@ -79,11 +83,11 @@ void copy_to_output_32(PF_EffectWorld* output, int x, int y, int max_x, const Co
 
 /*******************************************************************************************************
 Copies a value to the output buffer. (16-bit components)
-Note: If we are using SIMD the value may contain multiple pixels.
+Note: If we are using SIMD the value may contain multiple pixels, laid out as packet P. (x, y is the top left pixel)
 Note: Adobe uses ARGB colour order, with unmultiplied alpha.
 Note: Adobe 16-bit is not full 16-bit.  White is 0x8000
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 void copy_to_output_16(PF_EffectWorld* output, int x, int y, int max_x, ColourRGBA<S> c) {
 
 	
@@ -95,13 +99,13 @@ void copy_to_output_16(PF_EffectWorld* output, int x, int y, int max_x, ColourRG
 	c.blue = clamp(c.blue * white, black, white);
 	c.alpha = clamp(c.alpha * white, black, white);
 
-	//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)  
-	auto ptrY = (uint8_t*)output->data;
-	ptrY += y * output->rowbytes;
-
 	for (int i = 0; i < S::number_of_elements(); i++) {
-		if (x + i >= max_x) break;
-		auto ptrByte = ptrY + (x + i) * 4 * sizeof(uint16_t);  //Advance to x location.
+		if (x + P::lane_x(i) >= max_x) continue;
+
+		//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)  
+		auto ptrY = (uint8_t*)output->data;
+		ptrY += (y + P::lane_y(i)) * output->rowbytes;
+		auto ptrByte = ptrY + (x + P::lane_x(i)) * 4 * sizeof(uint16_t);  //Advance to x location.
 
 		auto ptrU16 = (uint16_t*)ptrByte;
 		ptrU16[0] = static_cast<uint16_t>(c.alpha.element(i));
@@ -115,10 +119,10 @@ void copy_to_output_16(PF_EffectWorld* output, int x, int y, int max_x, ColourRG
 
 /*******************************************************************************************************
 Copies a value to the output buffer. (8-bit components)
-Note: If we are using SIMD the value may contain multiple pixels.
+Note: If we are using SIMD the value may contain multiple pixels, laid out as packet P. (x, y is the top left pixel)
 Note: Adobe uses ARGB colour order, with unmultiplied alpha.
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 void copy_to_output_8(PF_EffectWorld* output, int x, int y, int max_x, ColourRGBA<S> c) {
 	constexpr unsigned short adobe_white8 = 0xff;
 	
@@ -130,13 +134,13 @@ void copy_to_output_8(PF_EffectWorld* output, int x, int y, int max_x, ColourRGB
 	c.alpha = clamp(c.alpha * white, black, white);
 
 
-	//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)
-	auto ptrY = (uint8_t*)output->data;
-	ptrY += y * output->rowbytes;
-
 	for (int i = 0; i < S::number_of_elements(); i++) {
-		if (x + i >= max_x) break;
-		auto ptrByte = ptrY + (x + i) * 4 * sizeof(uint8_t);  //Advance to x location.
+		if (x + P::lane_x(i) >= max_x) continue;
+
+		//Advance pointer to correct line (y).  (We must multiply by rowbytes in case the lines are padded.)
+		auto ptrY = (uint8_t*)output->data;
+		ptrY += (y + P::lane_y(i)) * output->rowbytes;
+		auto ptrByte = ptrY + (x + P::lane_x(i)) * 4 * sizeof(uint8_t);  //Advance to x location.
 				
 		ptrByte[0] = static_cast<uint8_t>(c.alpha.element(i));
 		ptrByte[1] = static_cast<uint8_t>(c.red.element(i));
@@ -201,15 +205,16 @@ static inline ColourRGBA<Simd512Float32> gather_image_data_avx512(float* in) {
 /*******************************************************************************************************
 8-bit
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 static inline ColourRGBA<S> read_input_pixel8(const RenderData<S>* rd, int x, int y) {	
-	const int sourceOffset = ((rd->inputLayer->rowbytes * y) + (x * 4 * sizeof(uint8_t)));
-	uint8_t* ptr = reinterpret_cast<uint8_t*>(sourceOffset + reinterpret_cast<uint8_t*>(rd->inputLayer->data));
-
-	//Convert to float data  (probably better to use simd)
+	//Convert to float data, one packet row at a time  (probably better to use simd)
 	alignas(sizeof(S)) std::array<float, S::number_of_elements() * 4> float_data;
-	for (int i = 0; i < S::number_of_elements() * 4; i++) {
-		float_data[i] = static_cast<float>(*ptr++) / static_cast<float>(white8);
+	for (int row = 0; row < P::rows; row++) {
+		const int sourceOffset = ((rd->inputLayer->rowbytes * (y + row)) + (x * 4 * sizeof(uint8_t)));
+		uint8_t* ptr = reinterpret_cast<uint8_t*>(sourceOffset + reinterpret_cast<uint8_t*>(rd->inputLayer->data));
+		for (int i = row * P::columns * 4; i < (row + 1) * P::columns * 4; i++) {
+			float_data[i] = static_cast<float>(*ptr++) / static_cast<float>(white8);
+		}
 	}
 
 	//Gather colour data into SIMD vectors
@@ -225,15 +230,16 @@ static inline ColourRGBA<S> read_input_pixel8(const RenderData<S>* rd, int x, in
 /*******************************************************************************************************
 16-bit
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 static inline ColourRGBA<S> read_input_pixel16(const RenderData<S>* rd, int x, int y) {
-	const int sourceOffset = ((rd->inputLayer->rowbytes * y) + (x * 4 * sizeof(uint16_t)));
-	uint16_t* ptr = reinterpret_cast<uint16_t*>(sourceOffset + reinterpret_cast<uint8_t*>(rd->inputLayer->data));
-	
-	//Convert to float data (probably better to use simd)
+	//Convert to float data, one packet row at a time (probably better to use simd)
 	alignas(sizeof(S)) std::array<float, S::number_of_elements() * 4> float_data;
-	for (int i = 0; i < S::number_of_elements() * 4; i++) {
-		float_data[i] = static_cast<float>(*ptr++)/ static_cast<float>(adobe_white16);
+	for (int row = 0; row < P::rows; row++) {
+		const int sourceOffset = ((rd->inputLayer->rowbytes * (y + row)) + (x * 4 * sizeof(uint16_t)));
+		uint16_t* ptr = reinterpret_cast<uint16_t*>(sourceOffset + reinterpret_cast<uint8_t*>(rd->inputLayer->data));
+		for (int i = row * P::columns * 4; i < (row + 1) * P::columns * 4; i++) {
+			float_data[i] = static_cast<float>(*ptr++)/ static_cast<float>(adobe_white16);
+		}
 	}	
 
 	//Gather colour data into SIMD vectors
@@ -248,10 +254,20 @@ static inline ColourRGBA<S> read_input_pixel16(const RenderData<S>* rd, int x, i
 /*******************************************************************************************************
 32-bit
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 static inline ColourRGBA<S> read_input_pixel32(const RenderData<S>* rd, int x, int y) {
 	const int sourceOffset = ((rd->inputLayer->rowbytes * y) + (x * 4 * sizeof(float))) ;
 	float* ptr = reinterpret_cast<float*>(sourceOffset + reinterpret_cast<uint8_t*>(rd->inputLayer->data));
+
+	//Multi-row packets: copy each packet row next to each other first
+	alignas(sizeof(S)) std::array<float, S::number_of_elements() * 4> float_data;
+	if constexpr (P::rows > 1) {
+		for (int row = 0; row < P::rows; row++) {
+			const float* src = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(ptr) + rd->inputLayer->rowbytes * row);
+			std::copy(src, src + P::columns * 4, &float_data[row * P::columns * 4]);
+		}
+		ptr = &float_data[0];
+	}
 	
 	//Check size of SIMD lane
 	if constexpr (sizeof(typename S::F) == 4) {
@@ -271,136 +287,184 @@ static inline ColourRGBA<S> read_input_pixel32(const RenderData<S>* rd, int x, i
 
 /*******************************************************************************************************
 8-bit
-Renders a pixel (or a simd vector's worth of pixels)
+Renders a pixel (or a simd vector's worth of pixels, laid out as packet P with top left pixel x, y)
 Passes of to actual project renderer
 *******************************************************************************************************/
-template <SimdFloat S>
+template <SimdFloat S, typename P>
 static inline void render_pixel8(const RenderData<S> * rd, int x, int y) {
 	if constexpr (project_uses_input) {
-		ColourRGBA<S> input_colour = read_input_pixel8(rd,x,y);
-		auto c =  rd->renderer.render_pixel_with_input(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)), input_colour);
-		copy_to_output_8(rd->output, x, y, rd->area.right, c);
+		ColourRGBA<S> input_colour = read_input_pixel8<P>(rd,x,y);
+		auto c =  rd->renderer.render_pixel_with_input(P::x(x), P::y(y), input_colour);
+		copy_to_output_8<P>(rd->output, x, y, rd->area.right, c);
 	}
 	else {
-		auto c = rd->renderer.render_pixel(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)));
-		copy_to_output_8(rd->output, x, y, rd->area.right, c);
+		auto c = rd->renderer.template render_packet<P>(x, y);
+		copy_to_output_8<P>(rd->output, x, y, rd->area.right, c);
 	}
 }
 
 /*******************************************************************************************************
 16-bit
-Renders a pixel (or a simd vector's worth of pixels)
+Renders a pixel (or a simd vector's worth of pixels, laid out as packet P with top left pixel x, y)
 Passes of to actual project renderer
 *******************************************************************************************************/
-template <SimdFloat S>
+template <SimdFloat S, typename P>
 static inline void render_pixel16(const RenderData<S>* rd, int x, int y) {
 	if constexpr (project_uses_input) {
-		ColourRGBA<S> input_colour = read_input_pixel16(rd,x,y);
-		auto c = rd->renderer.render_pixel_with_input(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)), input_colour);
-		copy_to_output_16(rd->output, x, y, rd->area.right, c);
+		ColourRGBA<S> input_colour = read_input_pixel16<P>(rd,x,y);
+		auto c = rd->renderer.render_pixel_with_input(P::x(x), P::y(y), input_colour);
+		copy_to_output_16<P>(rd->output, x, y, rd->area.right, c);
 	}
 	else {
-		auto c = rd->renderer.render_pixel(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)));
-		copy_to_output_16(rd->output, x, y, rd->area.right, c);
+		auto c = rd->renderer.template render_packet<P>(x, y);
+		copy_to_output_16<P>(rd->output, x, y, rd->area.right, c);
 	}
 }
 
 /*******************************************************************************************************
 32-bit
-Renders a pixel (or a simd vector's worth of pixels)
+Renders a pixel (or a simd vector's worth of pixels, laid out as packet P with top left pixel x, y)
 Passes of to actual project renderer
 *******************************************************************************************************/
-template <SimdFloat S>
+template <SimdFloat S, typename P>
 static inline void render_pixel32(const RenderData<S>* rd, int x, int y) {
 	if constexpr (project_uses_input) {
-		ColourRGBA<S> input_colour = read_input_pixel32(rd,x,y);
-		auto c = rd->renderer.render_pixel_with_input(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)), input_colour);
-		copy_to_output_32(rd->output, x, y, rd->area.right, c);
+		ColourRGBA<S> input_colour = read_input_pixel32<P>(rd,x,y);
+		auto c = rd->renderer.render_pixel_with_input(P::x(x), P::y(y), input_colour);
+		copy_to_output_32<P>(rd->output, x, y, rd->area.right, c);
 	}
 	else {
-		auto c = rd->renderer.render_pixel(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)));
-		copy_to_output_32(rd->output, x, y, rd->area.right, c);
+		auto c = rd->renderer.template render_packet<P>(x, y);
+		copy_to_output_32<P>(rd->output, x, y, rd->area.right, c);
 	}
 }
 
 
 
 /*******************************************************************************************************
-Callback for After Effects Iteration Suite.  Renders an 32-bit line of pixels.
-This thread callback will give us a line to render.
-Note: Adobe uses ARGB colour order, with unmultiplied alpha.
+Renders a row of packets (P::rows lines from y) one stage at a time, in tiles of project_tile_packets.
 *******************************************************************************************************/
-template <SimdFloat S>
-static PF_Err render_8bit_pixel_callback(void* refcon, [[maybe_unused]]  A_long thread_idxL, A_long  i, [[maybe_unused]] A_long itrtL) noexcept {
-	const auto rd = static_cast<RenderData<S> *>(refcon);
-	const auto y = i;
-	if (y < rd->area.top || y >= rd->area.bottom) [[unlikely]] return PF_Err_NONE;  //Check vertical bounds
+template <SimdFloat S, typename P, int bits>
+static inline void render_line_staged(const RenderData<S>* rd, int y) {
+	thread_local RenderTile<S> tile{};
+	thread_local std::vector<int> packet_x{};
 
+	//Left pixel of each packet.  (The last packet overlaps its neighbour if the width is not a multiple of P::columns)
+	packet_x.clear();
 	int x = rd->area.left;
-	for (; x < rd->area.right - S::number_of_elements() + 1; x += S::number_of_elements()) {		
-		render_pixel8<S>(rd, x, y);		
+	for (; x < rd->area.right - P::columns + 1; x += P::columns) packet_x.push_back(x);
+	if (x < rd->area.right && rd->area.right > P::columns) [[unlikely]] {
+		packet_x.push_back(x - (P::columns - (rd->area.right - x)));
 	}
-	
-	//Handle the case where the width is not a multiple of S::number_of_elements
-	if (x < rd->area.right && rd->area.right>S::number_of_elements()) [[unlikely]] {		
-		x -= S::number_of_elements() - (rd->area.right - x);		
-		render_pixel8<S>(rd, x, y);		
+
+	for (size_t first = 0; first < packet_x.size(); first += project_tile_packets) {
+		const size_t count = std::min(packet_x.size() - first, static_cast<size_t>(project_tile_packets));
+		tile.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			tile.packet_x[i] = packet_x[first + i];
+			tile.packet_y[i] = y;
+		}
+		rd->renderer.render_tile(tile);
+		for (size_t i = 0; i < count; i++) {
+			if constexpr (bits == 8) copy_to_output_8<P>(rd->output, packet_x[first + i], y, rd->area.right, tile.colour[i]);
+			if constexpr (bits == 16) copy_to_output_16<P>(rd->output, packet_x[first + i], y, rd->area.right, tile.colour[i]);
+			if constexpr (bits == 32) copy_to_output_32<P>(rd->output, packet_x[first + i], y, rd->area.right, tile.colour[i]);
+		}
+	}
+}
+
+/*******************************************************************************************************
+Renders a row of packets (P::rows lines from y), at 8, 16 or 32 bits per component.
+*******************************************************************************************************/
+template <SimdFloat S, typename P, int bits>
+static inline void render_line(const RenderData<S>* rd, int y) {
+	//Tiles are in RenderPacket<S> layout, so the scan lines at the top & bottom of the area are rendered per packet.
+	if constexpr (project_uses_staged_tiles && !project_uses_input && std::is_same_v<P, RenderPacket<S>>) {
+		render_line_staged<S, P, bits>(rd, y);
+		return;
+	}
+
+	const auto render = [rd, y](int x) {
+		if constexpr (bits == 8) render_pixel8<S, P>(rd, x, y);
+		if constexpr (bits == 16) render_pixel16<S, P>(rd, x, y);
+		if constexpr (bits == 32) render_pixel32<S, P>(rd, x, y);
+	};
+
+	int x = rd->area.left;
+	for (; x < rd->area.right - P::columns + 1; x += P::columns) {
+		render(x);
+	}
+
+	//Handle the case where the width is not a multiple of P::columns
+	if (x < rd->area.right && rd->area.right > P::columns) [[unlikely]] {
+		x -= P::columns - (rd->area.right - x);
+		render(x);
+	}
+}
+
+/*******************************************************************************************************
+Renders the i'th row of packets (RenderPacket<S>::rows lines).
+Lines near the top & bottom of the area that don't fill a packet use one scan line per packet.
+*******************************************************************************************************/
+template <SimdFloat S, int bits>
+static inline void render_packet_row(const RenderData<S>* rd, A_long i) {
+	using P = RenderPacket<S>;
+	const int y = static_cast<int>(i) * P::rows;
+	if (y >= rd->area.bottom || y + P::rows <= rd->area.top) [[unlikely]] return;  //Check vertical bounds
+
+	if (y >= rd->area.top && y + P::rows <= rd->area.bottom) [[likely]] {
+		render_line<S, P, bits>(rd, y);
+		return;
+	}
+	for (int line = std::max(y, static_cast<int>(rd->area.top)); line < std::min(y + P::rows, static_cast<int>(rd->area.bottom)); line++) {
+		render_line<S, PixelPacket<S>, bits>(rd, line);
 	}
+}
+
+/*******************************************************************************************************
+Number of times to call the iteration callbacks.  (One call per row of packets)
+*******************************************************************************************************/
+template <SimdFloat S>
+static inline A_long packet_row_count(int height) {
+	return static_cast<A_long>((height + RenderPacket<S>::rows - 1) / RenderPacket<S>::rows);
+}
 
+/*******************************************************************************************************
+Callback for After Effects Iteration Suite.  Renders an 8-bit row of packets.
+This thread callback will give us a row of packets to render.
+Note: Adobe uses ARGB colour order, with unmultiplied alpha.
+*******************************************************************************************************/
+template <SimdFloat S>
+static PF_Err render_8bit_pixel_callback(void* refcon, [[maybe_unused]]  A_long thread_idxL, A_long  i, [[maybe_unused]] A_long itrtL) noexcept {
+	const auto rd = static_cast<RenderData<S> *>(refcon);
+	render_packet_row<S, 8>(rd, i);
 	return PF_Err_NONE;
 
 }
 
 /*******************************************************************************************************
-Callback for After Effects Iteration Suite.  Renders an 16-bit pixel.
+Callback for After Effects Iteration Suite.  Renders a 16-bit row of packets.
 Note: Adobe 16 bit is not full 16-bit.  White is 0x8000
 Note: Adobe uses ARGB colour order, with unmultiplied alpha.
 *******************************************************************************************************/
 template <SimdFloat S>
 static PF_Err render_16bit_pixel_callback(void* refcon, A_long , A_long  i, [[maybe_unused]]  A_long itrtL) noexcept {
 	const auto rd = static_cast<RenderData<S> *>(refcon);
-	const auto y = i;
-	if (y < rd->area.top || y >= rd->area.bottom) [[unlikely]] return PF_Err_NONE;  //Check vertical bounds
-
-	int x = rd->area.left;
-	for (; x < rd->area.right - S::number_of_elements() + 1; x += S::number_of_elements()) {
-		render_pixel16<S>(rd, x, y);		
-	}
-
-	//Handle the case where the width is not a multiple of S::number_of_elements
-	if (x < rd->area.right && rd->area.right>S::number_of_elements()) [[unlikely]] {
-		x -= S::number_of_elements() - (rd->area.right - x);
-		render_pixel16<S>(rd, x, y);		
-	}
+	render_packet_row<S, 16>(rd, i);
 	return PF_Err_NONE;	
 }
 
 
 
 /*******************************************************************************************************
-Callback for After Effects Iteration Suite.  Renders an 32-bit line of pixels.
-This thread callback will give us a line to render.
+Callback for After Effects Iteration Suite.  Renders a 32-bit row of packets.
+This thread callback will give us a row of packets to render.
 Note: Adobe uses ARGB colour order, with unmultiplied alpha.
 *******************************************************************************************************/
 template <SimdFloat S>
 static PF_Err render_32bit_pixel_callback(void* refcon, A_long , A_long  i, [[maybe_unused]]  A_long itrtL) noexcept {
 	const auto rd = static_cast<RenderData<S> *>(refcon);
-	const auto y = i;
-	
-	
-	if (y < rd->area.top || y >= rd->area.bottom) [[unlikely]] return PF_Err_NONE;  //Check vertical bounds
-
-	int x = rd->area.left;
-	for (; x < rd->area.right - S::number_of_elements() + 1; x += S::number_of_elements()) {
-		render_pixel32<S>(rd, x, y);
-	}
-
-	//Handle the case where the width is not a multiple of S::number_of_elements
-	if (x < rd->area.right && rd->area.right>S::number_of_elements()) [[unlikely]] {
-		x -= S::number_of_elements() - (rd->area.right - x);
-		render_pixel32<S>(rd, x, y);
-	}
-	
+	render_packet_row<S, 32>(rd, i);
 	return PF_Err_NONE;
 
 }
@@ -427,24 +491,25 @@ Read Parameters from After Effects and put into data into our parameter list.
 *******************************************************************************************************/
 ParameterList read_parameters() {
 	auto params = build_project_parameters();
-	for (auto & p : params.entries) {
+	for (const auto & p : params.entries()) {
 		switch (p.type) {
 		case ParameterType::seed:
-			p.value = ParameterHelper::ReadSlider(p.id);
-			p.value_integer = static_cast<int>(round(p.value));
-			break;
 		case ParameterType::number:
-			p.value = ParameterHelper::ReadSlider(p.id);		
-			p.value_integer = static_cast<int>(round(p.value));
+		{
+			const double value = ParameterHelper::ReadSlider(p.id);
+			params.set_value(p.id, value);
+			params.set_value_integer(p.id, static_cast<int>(round(value)));
+			break;
+		}
+		case ParameterType::list:
+			params.set_value_integer(p.id, static_cast<int>(ParameterHelper::ReadList(p.id)) - 1);	//AE lists start at 1
 			break;
-		case ParameterType::list:			
-			p.value_string = ParameterHelper::ReadListAsString(p.id, p.list);
 		case ParameterType::colour:
+		{
 			auto pixel = ParameterHelper::ReadColour(p.id);
-			p.red = pixel.red / 255.0f;
-			p.green = pixel.green / 255.0f;
-			p.blue = pixel.blue / 255.0f;
+			params.set_colour(p.id, pixel.red / 255.0f, pixel.green / 255.0f, pixel.blue / 255.0f);
 			break;
+		}
 
 		default:
 			break;
@@ -527,15 +592,15 @@ void after_effect_cpu_dispatch(int width, int height, PF_InData* in_data, [[mayb
 	switch (bit_depth) {
 	case 8:
 	{
-		check_after_effects(suites.Iterate8Suite1()->iterate_generic(rd.height, &rd , render_8bit_pixel_callback<S>));
+		check_after_effects(suites.Iterate8Suite1()->iterate_generic(packet_row_count<S>(rd.height), &rd, render_8bit_pixel_callback<S>));
 		break;
 	}
 	case 16: {
-		check_after_effects(suites.Iterate8Suite1()->iterate_generic(rd.height, &rd, render_16bit_pixel_callback<S>));
+		check_after_effects(suites.Iterate8Suite1()->iterate_generic(packet_row_count<S>(rd.height), &rd, render_16bit_pixel_callback<S>));
 		break;
 	}
 	case 32: {
-		check_after_effects(suites.Iterate8Suite1()->iterate_generic(rd.height, &rd, render_32bit_pixel_callback<S>));
+		check_after_effects(suites.Iterate8Suite1()->iterate_generic(packet_row_count<S>(rd.height), &rd, render_32bit_pixel_callback<S>));
 		break;
 	}
 	default: break;
@@ -347,7 +347,7 @@ void add_parameters(const OfxImageEffectHandle effect) {
     auto params = build_project_parameters();
 
     //Build After Effect Parameters
-    for (auto p : params.entries) {
+    for (const auto& p : params.entries()) {
         switch (p.type) {
         case ParameterType::seed:
             //master_parameter_helper.add_slider(p.id, p.name, static_cast<float>(p.min), static_cast<float>(p.max), static_cast<float>(p.slider_min), static_cast<float>(p.slider_max), static_cast<float>(p.initial_value), 0);
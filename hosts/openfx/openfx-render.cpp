@@ -43,10 +43,13 @@ TODO: 8-BIT Support
 #include "..\..\common\simd-cpuid.h"
 #include "..\..\common\simd-f32.h"
 #include "..\..\common\simd-uint32.h"
+#include "..\..\common\pixel-packet.h"
 
 
+#include <algorithm>
 #include <bit>
 #include <memory>
+#include <vector>
 
 
 //Contains data that will be sent to different threads.
@@ -66,8 +69,9 @@ template <SimdFloat S> void thread_entry_pixel_render(unsigned int threadIndex,
 template <SimdFloat S> static void render_line(RenderThreadData<S>* rd, int y);
 template <SimdFloat S> static void do_render(OfxImageEffectHandle instance, OfxRectI& render_window, Renderer<S>& renderer, [[maybe_unused]] int width, [[maybe_unused]] int height, ClipHolder& output, const OfxTime& time);
 template <SimdFloat S> static void setup_render(Renderer<S>& renderer, int width, int height, ParameterHelper& parameter_helper, OfxTime time);
-template <SimdFloat S> static inline void render_pixel32(RenderThreadData<S>* rd, int x, int y);
-template <SimdFloat S> static void render_line32(RenderThreadData<S>* rd, int y);
+template <SimdFloat S, typename P> static inline void render_pixel32(RenderThreadData<S>* rd, int x, int y);
+template <SimdFloat S, typename P> static void render_line32(RenderThreadData<S>* rd, int y);
+template <SimdFloat S, typename P> static void render_line32_staged(RenderThreadData<S>* rd, int y);
 
 
 
@@ -188,20 +192,17 @@ Read the parameters values from the host and store in a host-independant paramet
 static ParameterList read_parameters(ParameterHelper& parameter_helper, OfxTime time) {
     auto params = build_project_parameters();
     
-    for (auto& p : params.entries) {
+    for (const auto& p : params.entries()) {
         switch (p.type) {
         case ParameterType::seed:
-            p.value_integer = parameter_helper.read_integer(p.id, time);
+            params.set_value_integer(p.id, parameter_helper.read_integer(p.id, time));
             break;
         case ParameterType::number:
-            p.value = parameter_helper.read_slider(p.id, time);
+            params.set_value(p.id, parameter_helper.read_slider(p.id, time));
             break;
         case ParameterType::list:
-        {
-            int i = parameter_helper.read_list(p.id, time);
-            p.value_string = p.list[i];
+            params.set_value_integer(p.id, parameter_helper.read_list(p.id, time));
             break;
-        }
 
         default:
             break;
@@ -211,9 +212,10 @@ static ParameterList read_parameters(ParameterHelper& parameter_helper, OfxTime
 }
 
 /*******************************************************************************************************
-
+Copies a packet of pixels to the output buffer.
+Lanes are scattered to their rows using the packet layout P.  (x, y is the top left pixel)
 *******************************************************************************************************/
-template <SimdFloat S>
+template <typename P, SimdFloat S>
 inline static void copy_pixel_to_output_buffer(ClipHolder& output, int x, int y, int max_x, ColourRGBA<S> c) {
     const bool hasAlpha = output.componentsPerPixel == 4;
 
@@ -229,8 +231,8 @@ inline static void copy_pixel_to_output_buffer(ClipHolder& output, int x, int y,
             constexpr auto w8 = static_cast<Precision>(white8);
             
             for (int i = 0; i < S::number_of_elements(); i++) {
-                if (x + i >= max_x) break;
-                const auto ptrDest = output.pixelAddress8(x+i, y);
+                if (x + P::lane_x(i) >= max_x) continue;
+                const auto ptrDest = output.pixelAddress8(x + P::lane_x(i), y + P::lane_y(i));
                 ptrDest[0] = static_cast<uint8_t>(clamp(c.red.element(i) * w8,0.0f,w8));
                 ptrDest[1] = static_cast<uint8_t>(clamp(c.green.element(i) * w8, 0.0f, w8));
                 ptrDest[2] = static_cast<uint8_t>(clamp(c.blue.element(i) * w8, 0.0f, w8));
@@ -243,8 +245,8 @@ inline static void copy_pixel_to_output_buffer(ClipHolder& output, int x, int y,
             //TODO: Use SIMD       
             
             for (int i = 0; i < S::number_of_elements(); i++) {
-                if (x + i >= max_x) break;
-                const auto ptrDest = output.pixelAddressFloat(x+i, y);
+                if (x + P::lane_x(i) >= max_x) continue;
+                const auto ptrDest = output.pixelAddressFloat(x + P::lane_x(i), y + P::lane_y(i));
                 ptrDest[0] = static_cast<float>(c.red.element(i));
                 ptrDest[1] = static_cast<float>(c.green.element(i)); 
                 ptrDest[2] = static_cast<float>(c.blue.element(i)); 
@@ -297,12 +299,14 @@ Thread Entry Point for rendering.
 Used as a callback by OpenFX host.
 
 Currently just balances worklaod using % operator.
+Work is split into rows of packets (RenderPacket<S>::rows lines each).
 *******************************************************************************************************/
 template <SimdFloat S>
 void thread_entry_pixel_render(unsigned int threadIndex, [[maybe_unused]] unsigned int threadMax, void* customArg) {
     RenderThreadData<S>* rd = static_cast<RenderThreadData<S>*>(customArg);
-    for (int y = rd->render_window->y1; y < rd->render_window->y2; y++) {
-        if (y % threadMax == threadIndex) {
+    unsigned int row = 0;
+    for (int y = rd->render_window->y1; y < rd->render_window->y2; y += RenderPacket<S>::rows, row++) {
+        if (row % threadMax == threadIndex) {
             render_line(rd, y);
         }
     }
@@ -335,7 +339,7 @@ static void do_render(OfxImageEffectHandle instance, OfxRectI& render_window, Re
         global_MultiThreadSuite->multiThread(thread_entry_pixel_render<S>, num_threads, &rd);
     }
     else {
-        for (int y = render_window.y1; y < render_window.y2; y++) {
+        for (int y = render_window.y1; y < render_window.y2; y += RenderPacket<S>::rows) {
             if (global_EffectSuite->abort(instance)) return;
             render_line(&rd, y);
         }
@@ -344,66 +348,112 @@ static void do_render(OfxImageEffectHandle instance, OfxRectI& render_window, Re
 
 
 /*******************************************************************************************************
-Render a line.
+Render a row of packets, starting at line y.
+The last few lines of the window (less than a packet high) use one scan line per packet.
 (Called on a worker thread)
 *******************************************************************************************************/
 template <SimdFloat S>
 static void render_line(RenderThreadData<S>* rd, int y) {
+    using P = RenderPacket<S>;
     if (rd->output->bitDepth == 32 && rd->output->componentsPerPixel == 4) {
-        render_line32(rd, y);
+        if (y + P::rows <= rd->render_window->y2) [[likely]] {
+            render_line32<S, P>(rd, y);
+        }
+        else {
+            for (; y < rd->render_window->y2; y++) render_line32<S, PixelPacket<S>>(rd, y);
+        }
     }
     //TODO.  Other Bit Depths
 }
 
 /*******************************************************************************************************
-Render a line.  
+Render a row of packets (P::rows lines from y).
 (Called on a worker thread)
 *******************************************************************************************************/
-template <SimdFloat S>
+template <SimdFloat S, typename P>
 static void render_line32(RenderThreadData<S>* rd, int y) {
     //dev_log("Render Line " + std::to_string(y));
+    //Tiles are in RenderPacket<S> layout, so the scan lines at the bottom of the window are rendered per packet.
+    if constexpr (project_uses_staged_tiles && !project_uses_input && std::is_same_v<P, RenderPacket<S>>) {
+        render_line32_staged<S, P>(rd, y);
+        return;
+    }
 
     int x = rd->render_window->x1;
-    for (; x < rd->render_window->x2 - S::number_of_elements() + 1; x += S::number_of_elements()) {
-        render_pixel32(rd, x, y);
+    for (; x < rd->render_window->x2 - P::columns + 1; x += P::columns) {
+        render_pixel32<S, P>(rd, x, y);
     }
-    //Handle the case where the width is not a multiple of S::number_of_elements
-    if (x < rd->render_window->x2 && rd->render_window->x2 > S::number_of_elements()) [[unlikely]] {
-        x -= S::number_of_elements() - (rd->render_window->x2 - x);
-        render_pixel32(rd, x, y);
+    //Handle the case where the width is not a multiple of P::columns
+    if (x < rd->render_window->x2 && rd->render_window->x2 > P::columns) [[unlikely]] {
+        x -= P::columns - (rd->render_window->x2 - x);
+        render_pixel32<S, P>(rd, x, y);
 
     }
 }
 
 
 
+/*******************************************************************************************************
+Render a row of packets (P::rows lines from y) one stage at a time, in tiles of project_tile_packets.
+(Called on a worker thread)
+*******************************************************************************************************/
+template <SimdFloat S, typename P>
+static void render_line32_staged(RenderThreadData<S>* rd, int y) {
+    thread_local RenderTile<S> tile{};
+    thread_local std::vector<int> packet_x{};
+
+    //Left pixel of each packet.  (The last packet overlaps its neighbour if the width is not a multiple of P::columns)
+    packet_x.clear();
+    int x = rd->render_window->x1;
+    for (; x < rd->render_window->x2 - P::columns + 1; x += P::columns) packet_x.push_back(x);
+    if (x < rd->render_window->x2 && rd->render_window->x2 > P::columns) [[unlikely]] {
+        packet_x.push_back(x - (P::columns - (rd->render_window->x2 - x)));
+    }
+
+    for (size_t first = 0; first < packet_x.size(); first += project_tile_packets) {
+        const size_t count = std::min(packet_x.size() - first, static_cast<size_t>(project_tile_packets));
+        tile.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            tile.packet_x[i] = packet_x[first + i];
+            tile.packet_y[i] = y;
+        }
+        rd->renderer->render_tile(tile);
+        for (size_t i = 0; i < count; i++) {
+            copy_pixel_to_output_buffer<P>(*rd->output, packet_x[first + i], y, rd->render_window->x2, tile.colour[i]);
+        }
+    }
+}
+
+
+
 /*******************************************************************************************************
 32-bit
-Renders a pixel (or a simd vector's worth of pixels)
+Renders a pixel (or a simd vector's worth of pixels, laid out as packet P with top left pixel x, y)
 Passes of to actual project renderer
 *******************************************************************************************************/
-template <SimdFloat S>
+template <SimdFloat S, typename P>
 static inline void render_pixel32(RenderThreadData<S>* rd, int x, int y) {
     ColourRGBA<S> c;
     if constexpr (project_uses_input) {
         
-        //Loads pixels from input buffer. 
-        auto ptr = rd->input->pixelAddressFloat(x, y);
+        //Loads pixels from input buffer (one packet row at a time). 
         ColourRGBA<S> input_colour;
-        if (ptr) {
-            for (int i = 0; i < S::number_of_elements(); i++) {
+        for (int row = 0; row < P::rows; row++) {
+            auto ptr = rd->input->pixelAddressFloat(x, y + row);
+            if (!ptr) continue;
+            for (int i = row * P::columns; i < (row + 1) * P::columns; i++) {
                 input_colour.red.set_element(i, *(ptr++));
                 input_colour.green.set_element(i, *(ptr++));
                 input_colour.blue.set_element(i, *(ptr++));
                 input_colour.alpha.set_element(i, *(ptr++));
             }
         }
-        c = rd->renderer->render_pixel_with_input(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)), input_colour);        
+        c = rd->renderer->render_pixel_with_input(P::x(x), P::y(y), input_colour);        
     }
     else {
-        c = rd->renderer->render_pixel(S::make_sequential(static_cast<S::F>(x)), S(static_cast<S::F>(y)));        
+        c = rd->renderer->template render_packet<P>(x, y);
     }
-    copy_pixel_to_output_buffer(*rd->output, x, y, rd->render_window->x2, c);
+    copy_pixel_to_output_buffer<P>(*rd->output, x, y, rd->render_window->x2, c);
 }
 
 
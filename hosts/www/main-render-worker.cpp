@@ -107,7 +107,7 @@ uint32_t render_pixel(uint32_t x, uint32_t y){
     if (renderer.get_width() <= 0 || renderer.get_height() <=0) return 0xff0000ff; //Return red if caller has not set size.
     
 
-    auto c = renderer.render_pixel( x,y);
+    auto c = renderer.render_packet(static_cast<int>(x), static_cast<int>(y));
     //if (y==0) js_console_log(std::to_string(x) +  " " + std::to_string(c.red.v) + " " + std::to_string(c.green.v) + " " +  std::to_string(c.blue.v) );
 
     return c.to_colour8().to_uint32_keep_memory_layout();
@@ -0,0 +1,71 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+    Shared helpers for the benchmarks in this folder.
+
+    Times are the best of several runs, as the minimum is the least affected by other processes.
+    SIMD types are picked at run time (as the hosts do), so one build benchmarks every width the CPU supports.
+******************************************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+#include "../common/environment.h"
+#include "../common/simd-concepts.h"
+#include "../common/simd-cpuid.h"
+#include "../common/simd-f32.h"
+#include "../common/simd-uint32.h"
+#include "../common/simd-uint64.h"
+
+//Results are written here so the compiler can't remove the work being timed
+inline volatile float benchmark_sink{};
+
+//Best time of repeats calls of f, in milliseconds
+template <typename Function>
+double best_time_ms(int repeats, Function&& f) {
+    double best = 1e30;
+    for (int i = 0; i < repeats; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+//Calls f.template operator()<S>(name) for each 32-bit float type the CPU supports, narrowest first.  (Same checks as the OpenFX host)
+template <typename Function>
+void for_each_float32_type(Function&& f) {
+    static_assert(mt::environment::is_x64, "Only x86_64 implemented");
+    const CpuInformation cpu{};
+    f.template operator()<FallbackFloat32>("scalar");
+    f.template operator()<Simd128Float32>("sse");
+    if (Simd256UInt64::cpu_supported(cpu) && Simd256Float32::cpu_supported(cpu) && Simd256UInt32::cpu_supported(cpu)) {
+        f.template operator()<Simd256Float32>("avx2");
+    }
+    if (Simd512UInt64::cpu_supported(cpu) && Simd512Float32::cpu_supported(cpu) && Simd512UInt32::cpu_supported(cpu)) {
+        f.template operator()<Simd512Float32>("avx512");
+    }
+}
@@ -0,0 +1,93 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+    Benchmark of the pixel packet layouts.  (See project_uses_square_packets in config.h)
+
+    Renders the same frames with scan line packets and with square packets (PixelPacket in pixel-packet.h)
+    for each SIMD width the CPU supports, and prints the best time of each.  Both layouts give the same image.
+    The scalar type is skipped, as its packets are a single pixel in either layout.
+******************************************************************************************************/
+
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "parameters.h"
+#include "renderer.h"
+
+constexpr int width = 640;
+constexpr int height = 360;
+constexpr int repeats = 5;
+
+struct Scene {
+    const char* name;
+    double scale;
+    const char* transform;
+};
+
+const std::vector<Scene> scenes{
+    {"default", 1.0, "None"},
+    {"fine detail", 8.0, "None"},
+    {"wave", 1.0, "Wave"},
+};
+
+//Best time to render the frame with render_pixel(), in Rows x (lanes / Rows) packets
+template <SimdFloat S, int Rows>
+double render_ms(const Renderer<S>& renderer) {
+    using Packet = PixelPacket<S, Rows>;
+    return best_time_ms(repeats, [&renderer] {
+        S sum{ 0.0f };
+        for (int y = 0; y < height; y += Packet::rows) {
+            for (int x = 0; x < width; x += Packet::columns) {
+                const auto c = renderer.render_pixel(Packet::x(x), Packet::y(y));
+                sum += c.red + c.green + c.blue;
+            }
+        }
+        benchmark_sink = sum.element(0);
+    });
+}
+
+int main() {
+    std::printf("%dx%d, best of %d\n", width, height, repeats);
+    std::printf("%-8s %-12s %8s %12s %12s %8s\n", "type", "scene", "square", "scan ms", "square ms", "ratio");
+    for_each_float32_type([]<SimdFloat S>(const char* type) {
+        constexpr int rows = square_packet_rows<S>();
+        if constexpr (rows > 1) {
+            for (const auto& scene : scenes) {
+                auto params = build_project_parameters();
+                params.set_value(ParameterID::scale, scene.scale);
+                params.set_value_string(ParameterID::input_transform_type, scene.transform);
+                Renderer<S> renderer;
+                renderer.set_size(width, height);
+                renderer.set_seed_int(1234);
+                renderer.set_parameters(params);
+
+                const double scan = render_ms<S, 1>(renderer);
+                const double square = render_ms<S, rows>(renderer);
+                std::printf("%-8s %-12s %6dx%d %12.1f %12.1f %8.3f\n", type, scene.name, S::number_of_elements() / rows, rows, scan, square, square / scan);
+            }
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,160 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+    Test of the pixel packet layouts at the edges of an image.
+
+    Renders a frame the way the hosts do: RenderPacket<S> rows (square packets) with render_packet() & render_tile(),
+    then single scan line packets for the lines at the bottom that don't fill a packet.
+    The height is not a multiple of RenderPacket<S>::rows, so both layouts are used.  Every pixel must match a
+    render_pixel() of the same pixel.
+
+    Runs each SIMD type the CPU supports.  Returns 0 on success.
+******************************************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "parameters.h"
+#include "renderer.h"
+#include "../common/simd-cpuid.h"
+#include "../common/simd-f32.h"
+#include "../common/simd-uint32.h"
+#include "../common/simd-uint64.h"
+
+constexpr int width = 96;
+constexpr int height = 37;
+
+//Largest difference allowed.  (Position tables & render_pixel() may round differently, a misplaced pixel is far larger)
+constexpr float tolerance = 1e-4f;
+
+using Image = std::vector<float>;
+
+//Writes packet c (layout P, top left pixel x, y) to image
+template <SimdFloat S, typename P>
+void store(Image& image, int x, int y, const ColourRGBA<S>& c) {
+    for (int i = 0; i < S::number_of_elements(); i++) {
+        const int px = x + P::lane_x(i);
+        const int py = y + P::lane_y(i);
+        if (py >= height) continue;
+        float* out = &image[(static_cast<size_t>(py) * width + px) * 3];
+        out[0] = c.red.element(i);
+        out[1] = c.green.element(i);
+        out[2] = c.blue.element(i);
+    }
+}
+
+//Lines from y to the bottom of the image, one scan line per packet
+template <SimdFloat S>
+void render_scan_lines(const Renderer<S>& renderer, Image& image, int y) {
+    using P = PixelPacket<S>;
+    for (; y < height; y++) {
+        for (int x = 0; x < width; x += P::columns) store<S, P>(image, x, y, renderer.template render_packet<P>(x, y));
+    }
+}
+
+template <SimdFloat S>
+Image render_packets(const Renderer<S>& renderer) {
+    using P = RenderPacket<S>;
+    Image image(static_cast<size_t>(width) * height * 3);
+    int y = 0;
+    for (; y + P::rows <= height; y += P::rows) {
+        for (int x = 0; x < width; x += P::columns) store<S, P>(image, x, y, renderer.render_packet(x, y));
+    }
+    render_scan_lines(renderer, image, y);
+    return image;
+}
+
+template <SimdFloat S>
+Image render_tiles(const Renderer<S>& renderer) {
+    using P = RenderPacket<S>;
+    Image image(static_cast<size_t>(width) * height * 3);
+    RenderTile<S> tile{};
+    int y = 0;
+    for (; y + P::rows <= height; y += P::rows) {
+        tile.resize(width / P::columns);
+        for (size_t i = 0; i < tile.size(); i++) {
+            tile.packet_x[i] = static_cast<int>(i) * P::columns;
+            tile.packet_y[i] = y;
+        }
+        renderer.render_tile(tile);
+        for (size_t i = 0; i < tile.size(); i++) store<S, P>(image, tile.packet_x[i], y, tile.colour[i]);
+    }
+    render_scan_lines(renderer, image, y);
+    return image;
+}
+
+//Reference: render_pixel() on scan lines
+template <SimdFloat S>
+Image render_pixels(const Renderer<S>& renderer) {
+    using P = PixelPacket<S>;
+    Image image(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x += P::columns) store<S, P>(image, x, y, renderer.render_pixel(P::x(x), P::y(y)));
+    }
+    return image;
+}
+
+int mismatches(const Image& a, const Image& b) {
+    int count = 0;
+    for (size_t i = 0; i < a.size(); i += 3) {
+        if (std::abs(a[i] - b[i]) > tolerance || std::abs(a[i + 1] - b[i + 1]) > tolerance || std::abs(a[i + 2] - b[i + 2]) > tolerance) count++;
+    }
+    return count;
+}
+
+template <SimdFloat S>
+int test(const char* name) {
+    int failures = 0;
+    for (const char* transform : { "None", "Wave" }) {
+        auto params = build_project_parameters();
+        params.set_value_string(ParameterID::input_transform_type, transform);
+        Renderer<S> renderer;
+        renderer.set_size(width, height);
+        renderer.set_seed_int(1234);
+        renderer.set_parameters(params);
+
+        const Image reference = render_pixels(renderer);
+        const int packets = mismatches(render_packets(renderer), reference);
+        const int tiles = mismatches(render_tiles(renderer), reference);
+        std::printf("%-7s %-5s %dx%d packets: %d, tiles: %d mismatched pixels\n", name, transform, width, height, packets, tiles);
+        failures += packets + tiles;
+    }
+    return failures;
+}
+
+int main() {
+    static_assert(mt::environment::is_x64, "Only x86_64 implemented");
+    static_assert(height % RenderPacket<Simd128Float32>::rows != 0, "The height must leave lines that don't fill a packet");
+    const CpuInformation cpu{};
+    int failures = test<Simd128Float32>("sse");
+    if (Simd256UInt64::cpu_supported(cpu) && Simd256Float32::cpu_supported(cpu) && Simd256UInt32::cpu_supported(cpu)) {
+        failures += test<Simd256Float32>("avx2");
+    }
+    if (Simd512UInt64::cpu_supported(cpu) && Simd512Float32::cpu_supported(cpu) && Simd512UInt32::cpu_supported(cpu)) {
+        failures += test<Simd512Float32>("avx512");
+    }
+    std::printf(failures ? "FAILED\n" : "Passed\n");
+    return failures ? 1 : 0;
+}
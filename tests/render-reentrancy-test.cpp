@@ -0,0 +1,191 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+    Stress test of the renderer's reentrancy contract.  (See the Renderer class comment)
+
+    Renders a set of frames serially, then again with every frame on its own thread at once,
+    then one frame with many threads sharing a single renderer.  Every result must match the
+    serial render bit for bit.  Also reads the renderer's random streams from many threads at once.
+
+    Runs with FallbackFloat32 (the type every host can run) and Simd128Float32.  Only SIMD types use
+    LatticeTable::shared(), the one piece of process wide mutable state.  Returns 0 on success.
+    On a machine with few cores a race may not change any pixels, so also run a build with a
+    race detector (eg. clang -fsanitize=thread) when changing shared or static state.
+******************************************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parameters.h"
+#include "renderer.h"
+#include "../common/simd-f32.h"
+
+constexpr int width = 96;
+constexpr int height = 64;
+
+struct Frame {
+    uint32_t seed;
+    double evolve1;
+    double evolve2;
+    const char* transform;
+};
+
+//Mixed seeds, evolve values (including large ones for the hybrid lattice) & input transforms
+const std::vector<Frame> frames{
+    {1234, 1.0, 0.0, "None"},
+    {1234, 1.0, 0.3, "Wave"},
+    {99, 5000.0, 0.7, "None"},
+    {99, 2.5, 0.1, "Abs(x,y)"},
+    {7, 1.0, 0.5, "Sqrt(Abs(x,y))"},
+    {7, 300.0, 0.9, "None"},
+    {31337, 1.0, 0.0, "Wave"},
+    {31337, 42.0, 0.25, "Abs(x,y)"},
+    {2, 1.0, 0.6, "None"},
+    {2, 1.0, 0.6, "Wave"},
+    {55, 0.5, 0.2, "None"},
+    {55, 9000.0, 0.4, "Sqrt(Abs(x,y))"},
+    {1234, 1.0, 0.0, "None"},
+    {99, 5000.0, 0.7, "None"},
+    {8, 12.0, 0.15, "Wave"},
+    {8, 1.0, 0.85, "Abs(x,y)"},
+};
+
+template <typename S>
+void setup(Renderer<S>& renderer, const Frame& frame) {
+    auto params = build_project_parameters();
+    params.set_value(ParameterID::evolve1, frame.evolve1);
+    params.set_value(ParameterID::evolve2, frame.evolve2);
+    params.set_value_string(ParameterID::input_transform_type, frame.transform);
+    renderer.set_size(width, height);
+    renderer.set_seed_int(frame.seed);
+    renderer.set_parameters(params);
+}
+
+//Renders rows first_row, first_row + row_step, ... into image (RGB floats)
+template <typename S>
+void render_rows(const Renderer<S>& renderer, std::vector<float>& image, int first_row, int row_step) {
+    for (int y = first_row; y < height; y += row_step) {
+        for (int x = 0; x < width; x += S::number_of_elements()) {
+            const auto c = renderer.template render_packet<PixelPacket<S>>(x, y);
+            for (int lane = 0; lane < S::number_of_elements(); lane++) {
+                float* out = &image[(static_cast<size_t>(y) * width + x + lane) * 3];
+                out[0] = c.red.element(lane);
+                out[1] = c.green.element(lane);
+                out[2] = c.blue.element(lane);
+            }
+        }
+    }
+}
+
+template <typename S>
+std::vector<float> render_frame(const Frame& frame) {
+    Renderer<S> renderer;
+    setup(renderer, frame);
+    std::vector<float> image(static_cast<size_t>(width) * height * 3);
+    render_rows(renderer, image, 0, 1);
+    return image;
+}
+
+bool same(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+//Runs the concurrent renders with type S.  Returns the number of failures.
+template <typename S>
+int test_renders(const char* name) {
+    int failures = 0;
+
+    //Serial reference
+    std::vector<std::vector<float>> reference;
+    for (const auto& frame : frames) reference.push_back(render_frame<S>(frame));
+
+    //One thread per frame, all at once
+    {
+        std::vector<std::vector<float>> results(frames.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < frames.size(); i++) threads.emplace_back([&results, i] { results[i] = render_frame<S>(frames[i]); });
+        for (auto& t : threads) t.join();
+        int mismatches = 0;
+        for (size_t i = 0; i < frames.size(); i++) if (!same(results[i], reference[i])) mismatches++;
+        std::printf("%s  %zu concurrent frames: %d mismatched\n", name, frames.size(), mismatches);
+        failures += mismatches;
+    }
+
+    //Many threads sharing one renderer
+    {
+        constexpr int thread_count = 8;
+        const auto& frame = frames[2];
+        Renderer<S> renderer;
+        setup(renderer, frame);
+        std::vector<float> image(static_cast<size_t>(width) * height * 3);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < thread_count; i++) threads.emplace_back([&renderer, &image, i] { render_rows(renderer, image, i, thread_count); });
+        for (auto& t : threads) t.join();
+        const bool ok = same(image, reference[2]);
+        std::printf("%s  %d threads sharing one renderer: %s\n", name, thread_count, ok ? "match" : "MISMATCH");
+        if (!ok) failures++;
+    }
+    return failures;
+}
+
+//Reads one renderer's random streams from many threads, each in a different order.  Returns the number of failures.
+int test_random_streams() {
+    constexpr int thread_count = 8;
+    constexpr int count = 1000;
+    Renderer<FallbackFloat32> renderer;
+    renderer.set_seed_int(1234);
+
+    std::vector<std::vector<double>> values(thread_count, std::vector<double>(count));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; i++) threads.emplace_back([&renderer, &values, i] {
+        const auto stream = renderer.random_stream(i % 2);
+        for (int k = 0; k < count; k++) {
+            const int index = (i & 2) ? count - 1 - k : k;
+            values[i][index] = stream.at<double>(index);
+        }
+    });
+    for (auto& t : threads) t.join();
+
+    int mismatches = 0;
+    for (int i = 0; i < thread_count; i++) {
+        const auto stream = RandomStream(1234, i % 2);
+        for (int k = 0; k < count; k++) if (values[i][k] != stream.at<double>(k) || values[i][k] < 0.0 || values[i][k] > 1.0) mismatches++;
+    }
+    std::printf("%d threads reading random streams: %d mismatched\n", thread_count, mismatches);
+    return mismatches;
+}
+
+int main() {
+    static_assert(mt::environment::is_x64, "Only x86_64 implemented");
+    int failures = 0;
+    failures += test_renders<FallbackFloat32>("scalar");
+    failures += test_renders<Simd128Float32>("sse");       //Always supported on x86_64
+    failures += test_random_streams();
+
+    std::printf(failures ? "FAILED\n" : "Passed\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/********************************************************************************************************
+
+Authors:		(c) 2023 Maths Town
+
+Licence:		The MIT License
+
+*********************************************************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the
+following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************
+
+Description:
+    Benchmark of the render kernel variants.  (See project_uses_render_variants in config.h)
+
+    Renders the same frames with the generic kernel and with the per-frame variant kernels, through both
+    render_packet() and render_tile(), for each SIMD width the CPU supports, and prints the best time of each.
+    All kernels give the same image.
+******************************************************************************************************/
+
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "parameters.h"
+#include "renderer.h"
+
+constexpr int width = 640;
+constexpr int height = 360;
+constexpr int repeats = 5;
+
+struct Scene {
+    const char* name;
+    double evolve1;
+    const char* transform;
+};
+
+//"None" with small evolve offsets is the frame the variants are for (both checks compiled out)
+const std::vector<Scene> scenes{
+    {"default", 1.0, "None"},
+    {"hybrid", 5000.0, "None"},
+    {"wave", 1.0, "Wave"},
+};
+
+template <SimdFloat S>
+double packet_ms(const Renderer<S>& renderer) {
+    using P = RenderPacket<S>;
+    return best_time_ms(repeats, [&renderer] {
+        S sum{ 0.0f };
+        for (int y = 0; y < height; y += P::rows) {
+            for (int x = 0; x < width; x += P::columns) {
+                const auto c = renderer.render_packet(x, y);
+                sum += c.red + c.green + c.blue;
+            }
+        }
+        benchmark_sink = sum.element(0);
+    });
+}
+
+template <SimdFloat S>
+double tile_ms(const Renderer<S>& renderer) {
+    using P = RenderPacket<S>;
+    RenderTile<S> tile{};
+    return best_time_ms(repeats, [&renderer, &tile] {
+        S sum{ 0.0f };
+        for (int y = 0; y < height; y += P::rows) {
+            for (int first = 0; first < width; first += P::columns * project_tile_packets) {
+                const int count = std::min(project_tile_packets, (width - first) / P::columns);
+                tile.resize(count);
+                for (int i = 0; i < count; i++) {
+                    tile.packet_x[i] = first + i * P::columns;
+                    tile.packet_y[i] = y;
+                }
+                renderer.render_tile(tile);
+                for (int i = 0; i < count; i++) sum += tile.colour[i].red + tile.colour[i].green + tile.colour[i].blue;
+            }
+        }
+        benchmark_sink = sum.element(0);
+    });
+}
+
+int main() {
+    std::printf("%dx%d, best of %d, variant / generic time\n", width, height, repeats);
+    std::printf("%-8s %-10s %12s %12s %8s %12s %12s %8s\n", "type", "scene", "packet ms", "variant ms", "ratio", "tile ms", "variant ms", "ratio");
+    for_each_float32_type([]<SimdFloat S>(const char* type) {
+        for (const auto& scene : scenes) {
+            auto params = build_project_parameters();
+            params.set_value(ParameterID::evolve1, scene.evolve1);
+            params.set_value_string(ParameterID::input_transform_type, scene.transform);
+            Renderer<S> renderer;
+            renderer.set_size(width, height);
+            renderer.set_seed_int(1234);
+            renderer.set_parameters(params);
+
+            renderer.template select_render_kernels<false>();
+            const double packet = packet_ms(renderer);
+            const double tile = tile_ms(renderer);
+            renderer.template select_render_kernels<true>();
+            const double packet_variant = packet_ms(renderer);
+            const double tile_variant = tile_ms(renderer);
+            std::printf("%-8s %-10s %12.1f %12.1f %8.3f %12.1f %12.1f %8.3f\n", type, scene.name,
+                packet, packet_variant, packet_variant / packet, tile, tile_variant, tile_variant / tile);
+        }
+    });
+    return 0;
+}
@@ -51,6 +51,53 @@ constexpr bool project_is_solid_render = true;
 constexpr bool project_is_multiprecision = false;
 typedef float Precision;
 
+//Noise lattice coordinates. (false = hash float bit patterns, the original look.  true = int32 lattice, see NoiseLattice in noise.h)
+constexpr bool project_uses_integer_lattice = false;
+
+//Noise basis for the 4D noise stages. (false = value noise, the original look.  true = simplex noise, an alternative look, see NoiseBasis in noise.h)
+//Simplex is slower here: 1.6-2.9x value noise on SIMD types & 3.3-4.1x on scalar (4D fbm_multi, 640x360), as value noise shares its per axis hash mixes between corners.
+constexpr bool project_uses_simplex_noise = false;
+
+//Hash the 16 corners of a scalar 4D noise cell across SIMD lanes. (Same output.  false = scalar tree, see lattice_corner_hashes_parallel in noise.h)
+//Slower here: 2M FallbackFloat32 value_noise(vec4) calls take 72-78 ms vs 58 ms (AVX-512), 108 vs 73 ms (AVX2), 134-142 vs 123 ms (SSE4.2).
+constexpr bool project_uses_parallel_corner_hashes = false;
+
+//Skip colour noise octaves finer than a pixel. (false = always render full detail)
+constexpr bool project_uses_band_limited_fbm = true;
+
+//Cache the lattice of low frequency noise octaves per thread. (Same output.  false = always hash, see LatticeCache in noise.h)
+constexpr bool project_uses_lattice_cache = true;
+
+//SIMD pixel packet layout. (Same output.  false = one scan line per packet, true = square blocks, see PixelPacket in pixel-packet.h, timed by tests/packet-benchmark.cpp)
+constexpr bool project_uses_square_packets = true;
+
+//Look up the lattice of the 2D noise stages in a table built once per seed. (Same output.  false = always hash, see LatticeTable in noise.h)  SSE & AVX2 only, see find_lattice_table in renderer.h
+constexpr bool project_uses_lattice_table = true;
+
+//First warp on a coarse grid of pixels, interpolated bicubically. (Not bit-identical.  false = every pixel, see CoarseGrid in coarse-grid.h)
+constexpr bool project_uses_warp_grid = false;
+constexpr int project_warp_grid_step = 8;               //Pixels between grid points. (A multiple of the SIMD packet size)
+constexpr double project_warp_grid_max_error = 0.005;   //Largest error (in pixels) at the checked points of a tile, larger tiles are rendered exactly
+
+//Render each row of packets one stage at a time, in tiles of SIMD packets. (Same output.  false = one packet at a time, see RenderTile in renderer.h)
+constexpr bool project_uses_staged_tiles = false;
+constexpr int project_tile_packets = 64;                //Packets per tile
+constexpr bool project_uses_half_tile_buffers = false;  //Keep the colour stage inputs as half floats. (Not bit-identical, see RenderTile in renderer.h)
+
+//Hybrid precision z/w for the 4D noise stages, picked per frame when the evolve offsets are too large for float32. (false = always float32, see LatticeCoordinate in noise.h)
+constexpr bool project_uses_hybrid_lattice = true;
+constexpr double project_hybrid_lattice_limit = 4096.0; //Largest z/w (in lattice cells, at the finest octave) left in float32.  (Steps of 1/2048 of a cell)
+
+//Look up the noise space position of each packet in per column & row tables, for separable input transforms. (Same output.  false = calculate per packet, see build_position_tables in renderer.h)
+constexpr bool project_uses_position_tables = true;
+
+//Pick a render kernel per frame with the unused features compiled out. (Same output.  false = one generic kernel, see select_render_kernels in renderer.h)
+//Off: no measurable gain & 4x the kernels to compile, timed by tests/render-variants-benchmark.cpp
+constexpr bool project_uses_render_variants = false;
+
+//Evolve noise stages. (false = 4D value noise, the original look.  true = 2D noise on a per-frame z/w slice, a faster alternative look, see NoiseSlice in noise.h)
+constexpr bool project_uses_noise_slices = false;
+
 
 
 
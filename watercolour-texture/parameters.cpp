@@ -40,17 +40,21 @@ Description:
 #include "parameter-id.h" 
 #include "..\common\input-transforms.h"
 
+//The definitions are built on first use, then shared by every list.  (Only the values are copied per frame)
 ParameterList build_project_parameters() {
-	ParameterList params;
-	params.add_entry(ParameterEntry::make_seed(ParameterID::seed, "Random Seed"));
-	params.add_entry(ParameterEntry::make_number(ParameterID::scale, "Scale Noise",0.0000001,10000.0,1.0,0.000001,100.0,2));
-	params.add_entry(ParameterEntry::make_number(ParameterID::directional_bias, "Directional Bias", -10000, 10000.0, 0.0, -100.0, 100.0, 2));
+	static const std::shared_ptr<const ParameterDefinitions> definitions = [] {
+		auto params = std::make_shared<ParameterDefinitions>();
+		params->add_entry(ParameterEntry::make_seed(ParameterID::seed, "Random Seed"));
+		params->add_entry(ParameterEntry::make_number(ParameterID::scale, "Scale Noise",0.0000001,10000.0,1.0,0.000001,100.0,2));
+		params->add_entry(ParameterEntry::make_number(ParameterID::directional_bias, "Directional Bias", -10000, 10000.0, 0.0, -100.0, 100.0, 2));
 
-	params.add_entry(ParameterEntry::make_number(ParameterID::evolve1, "Evolve (Linear/Speed)", -10000.0, 10000.0, 1.0, 0, 100.0, 2));
-	params.add_entry(ParameterEntry::make_number(ParameterID::evolve2, "Evolve (Loop)", -10000.0, 10000.0, 0.0, 0, 1, 4));
+		params->add_entry(ParameterEntry::make_number(ParameterID::evolve1, "Evolve (Linear/Speed)", -10000.0, 10000.0, 1.0, 0, 100.0, 2));
+		params->add_entry(ParameterEntry::make_number(ParameterID::evolve2, "Evolve (Loop)", -10000.0, 10000.0, 0.0, 0, 1, 4));
 
-	//Input Transforms (builds from common set used in multiple projects)
-	build_input_transforms_parameter_list(params);
+		//Input Transforms (builds from common set used in multiple projects)
+		build_input_transforms_parameter_list(*params);
 
-	return params;
+		return params;
+	}();
+	return ParameterList(definitions);
 }
\ No newline at end of file
@@ -28,43 +28,197 @@ Description:
 *******************************************************************************************************/
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <numbers>
 #include <typeinfo>
+#include <type_traits>
 
 #include "../../common/colour.h"
 #include "../../common/linear-algebra.h"
 #include "../../common/noise.h"
 #include "../../common/parameter-list.h"
 #include "..\..\common\input-transforms.h"
+#include "..\..\common\pixel-packet.h"
+#include "..\..\common\coarse-grid.h"
 
 #include "..\..\common\simd-cpuid.h"
 #include "..\..\common\simd-f32.h"
 #include "..\..\common\simd-uint32.h"
 #include "..\..\common\simd-concepts.h"
 
+#include "config.h"
+
+
+
+/**************************************************************************************************
+ * Pixel packet layout used by the hosts to build render_pixel() co-ordinates & store the results.
+ * ************************************************************************************************/
+template <SimdFloat S>
+using RenderPacket = PixelPacket<S, project_uses_square_packets ? square_packet_rows<S>() : 1>;
+
+
+/**************************************************************************************************
+ * Per-frame constants used by the renderer.
+ * Built once by set_size() / set_parameters() so render_pixel() only has to do noise math.
+ * Values are already broadcast into SIMD registers.
+ * ************************************************************************************************/
+template <SimdFloat S>
+struct RenderPlan {
+    bool valid{};               //False if the size has not been set (render_pixel returns black)
+
+    //Input transform
+    InputTransformPlan<S> input_transform{};
+
+    //Pixel co-ordinates to noise space, combined in double.  (See pixel_position)
+    affine2<S> pixel_to_noise{};        //Normalise, pre-transform, directional bias & scale.  (For "None", the whole chain)
+    affine2<S> pixel_to_transform{};    //Normalise & pre-transform.  (Input of the special transform)
+    vec2<S> noise_scale{};              //Directional bias & scale.  (After the special transform)
+
+    //Evolve (z & w co-ordinates of the 4D noise stages)
+    S evolve_x{};
+    S evolve_y{};
+    S evolve_x_stage2{};
+    S evolve_y_stage2{};
+    S red_z{};
+    S red_w{};
+    S green_z{};
+    S green_w{};
+    S blue_z{};
+    S blue_w{};
+
+    //Band-limited fbm detail for each noise stage, the warps are always full detail (see FbmDetail in noise.h)
+    FbmDetail<S> detail_warp_coarse{};  //First warp (8 octaves at 0.05 scale)
+    FbmDetail<S> detail_warp{};         //Remaining warps (4 octaves)
+    FbmDetail<S> detail_colour{};       //Final colour (8 octaves)
+
+    //Size of one pixel in noise space (approximate)
+    double footprint{};
+
+    //Octaves of the first warp that use the lattice cache (see LatticeCache in noise.h)
+    int cached_octaves_warp_coarse{};
+
+    //Noise space position of each pixel column & row, for separable input transforms.  (Empty if not used, see build_position_tables)
+    //Entry i is for packets with their top left pixel in column (or row) i.
+    std::vector<S> position_x{};
+    std::vector<S> position_y{};            //With a y offset: before the offset, bias & scale
+    std::vector<S> position_y_offset{};     //y offset of each column ("Wave" only, otherwise empty)
+
+    //Hybrid precision z/w of the 4D noise stages, for each input.  (Stage 3 adds the per pixel x/y.  See LatticeCoordinate in noise.h)
+    bool hybrid_lattice{};
+    std::array<std::array<LatticeCoordinate<S>, 2>, 2> hybrid_warp_coarse{};
+    std::array<std::array<LatticeCoordinate<S>, 2>, 2> hybrid_warp2{};
+    std::array<std::array<LatticeCoordinate<S>, 2>, 2> hybrid_warp3{};
+    std::array<std::array<LatticeCoordinate<S>, 2>, 3> hybrid_colour{};
+
+    //Evolve z/w slices of the 4D noise stages, for each input & octave (see NoiseSlice in noise.h)
+    std::array<std::array<NoiseSlice, 8>, 2> slices_warp_coarse{};
+    std::array<std::array<NoiseSlice, 4>, 2> slices_warp{};
+    std::array<std::array<NoiseSlice, 8>, 3> slices_colour{};
+};
+
+
+/**************************************************************************************************
+ * A packet's vec2 stored as half floats.  (See project_uses_half_tile_buffers)
+ * ************************************************************************************************/
+template <SimdFloat S>
+struct HalfVec2 {
+    std::array<uint16_t, S::number_of_elements()> x{};
+    std::array<uint16_t, S::number_of_elements()> y{};
+
+    HalfVec2() = default;
+    explicit HalfVec2(const vec2<S>& v) noexcept {
+        v.x.store_half(x.data());
+        v.y.store_half(y.data());
+    }
+    vec2<S> load() const noexcept { return vec2<S>(S::load_half(x.data()), S::load_half(y.data())); }
+};
+
+
+/**************************************************************************************************
+ * Buffers for rendering a tile of packets one stage at a time.  (See Renderer::render_tile)
+ * The host fills packet_x & packet_y with the top left pixel of each packet (RenderPacket<S> layout),
+ * render_tile fills the pixel co-ordinates of each lane (x & y) and colour.
+ * Each buffer is an array of whole SIMD registers, so a packet's lanes stay together (structure of arrays).
+ * ************************************************************************************************/
+template <SimdFloat S>
+struct RenderTile {
+    std::vector<int> packet_x{};
+    std::vector<int> packet_y{};
+    std::vector<S> x{};
+    std::vector<S> y{};
+    std::vector<ColourRGBA<S>> colour{};
+
+    //Stage outputs.  (The warp is updated in place, except for the three warps read by the colour stage)
+    //Half floats only have 11 bits of precision, too few for a noise space position (a pixel is ~0.003 at 1080p),
+    //so half storage keeps the colour stage's first two warps as the offset to the next warp (|offset| < 0.71).
+    static constexpr bool half = project_uses_half_tile_buffers && SimdFloat32<S>;
+    using WarpStore = std::conditional_t<half, HalfVec2<S>, vec2<S>>;
+    std::vector<vec2<S>> warp{};
+    std::vector<WarpStore> warp5{};
+    std::vector<WarpStore> warp6{};
+
+    size_t size() const noexcept { return x.size(); }
+    void resize(size_t packets) {
+        packet_x.resize(packets);
+        packet_y.resize(packets);
+        x.resize(packets);
+        y.resize(packets);
+        colour.resize(packets);
+        warp.resize(packets);
+        warp5.resize(packets);
+        warp6.resize(packets);
+    }
+};
+
+
+/**************************************************************************************************
+ * Time spent in each stage of render_tile.  (Accumulated over calls, in seconds)
+ * ************************************************************************************************/
+struct RenderStageTimes {
+    static constexpr int stages = 8;
+    static constexpr std::array<const char*, stages> names{ "position", "warp 1", "warp 2", "warp 3", "warp 4", "warp 5", "warp 6", "colour" };
+    std::array<double, stages> seconds{};
+};
 
 
 /**************************************************************************************************
  * The renderer class.
  * Implements a host independent pixel renderer.
  * Use type parameter to select floating point precision.
+ * The const render functions are reentrant: any number of threads may render with one renderer (or with
+ * several renderers for different frames) at once.  Lazily built state (the warp grid & lattice table) is built once
+ * under std::call_once, and per thread state (the lattice cache) is thread_local.  (Checked by tests/render-reentrancy-test.cpp)
  * ************************************************************************************************/
 template <SimdFloat S>
 class Renderer{
     
 
     private:
+        static constexpr auto lattice = project_uses_integer_lattice ? NoiseLattice::integer : NoiseLattice::float_bits;
+        static constexpr auto basis = project_uses_simplex_noise ? NoiseBasis::simplex : project_uses_parallel_corner_hashes ? NoiseBasis::value_parallel_corners : NoiseBasis::value;
+        static constexpr bool hybrid_lattice_supported = project_uses_hybrid_lattice && SimdFloat32<S> && !project_uses_noise_slices && !project_uses_simplex_noise;
+
         int width {};
         int height {};
-        typename S::F width_f {};
-        typename S::F height_f {};
-        typename S::F aspect {};
         std::string seed_string{};
         uint32_t seed{};
+        struct LazyLatticeTable {
+            std::once_flag once{};
+            std::shared_ptr<const LatticeTable> table{};       //Shared with other renderers using the same seed
+        };
+        std::shared_ptr<LazyLatticeTable> lattice_table = std::make_shared<LazyLatticeTable>();    //Found on first use (see find_lattice_table)
         ParameterList params{};
+        RenderPlan<S> plan{};
+        std::shared_ptr<CoarseGrid> warp_grid{};            //First warp on a coarse grid, built on first use (see build_warp_grid)
+        std::shared_ptr<std::once_flag> warp_grid_once{};
 
     public:
         //Constructor
@@ -79,10 +233,14 @@ class Renderer{
         void set_seed(const std::string & s){
             this->seed=string_to_seed(s);             
             this->seed_string = s; 
+            if constexpr (project_uses_lattice_table) lattice_table = std::make_shared<LazyLatticeTable>();
+            if constexpr (project_uses_noise_slices || project_uses_warp_grid) build_plan();
         }
         //Set an integer seed. (string will be ignored)
         void set_seed_int(uint32_t s){
             this->seed = s;
+            if constexpr (project_uses_lattice_table) lattice_table = std::make_shared<LazyLatticeTable>();
+            if constexpr (project_uses_noise_slices || project_uses_warp_grid) build_plan();
         }
         std::string get_seed() const { return seed_string;}
         uint32_t get_seed_int() const { return seed;}
@@ -90,14 +248,58 @@ class Renderer{
         //Parameters
         void set_parameters(ParameterList plist){
             params = plist;
+            build_plan();
         }
 
         //Render
         ColourRGBA<S> render_pixel(S x, S y) const;
+        template <typename P = RenderPacket<S>> ColourRGBA<S> render_packet(int x, int y) const;    //Packet with top left pixel (x, y), in layout P.  (Faster than render_pixel in the RenderPacket<S> layout)
         ColourRGBA<S> render_pixel_with_input(S x, S y, ColourRGBA<S>) const;
+        void render_tile(RenderTile<S>& tile, RenderStageTimes* times = nullptr) const {
+            if (!plan.valid) std::fill_n(tile.colour.begin(), tile.size(), ColourRGBA<S>{});
+            else (this->*tile_kernel)(tile, times);
+        }
 
-    private:
+        //Select the render kernels.  Called by build_plan with project_uses_render_variants.  (Public for tests/render-variants-benchmark.cpp)
+        template <bool variants> void select_render_kernels();
 
+        //A random stream for this render.  (Derived from the seed, the same stream number gives the same values in any thread)
+        RandomStream random_stream(uint64_t stream = 0) const noexcept { return RandomStream(seed, stream); }
+
+        //The calling thread's lattice cache.  (Hit rate statistics)
+        static LatticeCache<S>& thread_lattice_cache() {
+            thread_local LatticeCache<S> cache{};
+            return cache;
+        }
+
+    private:
+        //Render kernels for one frame, selected by build_plan.  (See select_render_kernels)
+        using PixelKernel = ColourRGBA<S>(Renderer::*)(S, S) const;
+        using PositionKernel = ColourRGBA<S>(Renderer::*)(const vec2<S>&, S, S) const;
+        using TileKernel = void(Renderer::*)(RenderTile<S>&, RenderStageTimes*) const;
+        PixelKernel pixel_kernel{};
+        PositionKernel position_kernel{};
+        TileKernel tile_kernel{};
+
+        void build_plan();
+        void build_position_tables();
+        const LatticeTable* find_lattice_table() const;
+        template <bool transform, bool hybrid> void build_warp_grid() const;
+        template <bool transform> vec2<S> pixel_position(S x, S y) const;
+        bool table_position(int x, int y, vec2<S>& p) const;
+        template <bool hybrid> vec2<S> warp_coarse(const vec2<S>& p) const;
+
+        //Render kernels.  transform = false: the input transform is "None" (a single matrix).  hybrid = false: plan.hybrid_lattice is false.
+        template <bool transform, bool hybrid> ColourRGBA<S> render_pixel_kernel(S x, S y) const;
+        template <bool transform, bool hybrid> ColourRGBA<S> render_position_kernel(const vec2<S>& p, S x, S y) const;
+        template <bool transform, bool hybrid> void render_tile_kernel(RenderTile<S>& tile, RenderStageTimes* times) const;
+
+        //Render stages.  (Each returns the next warped position, or the colour)
+        template <bool transform, bool hybrid> vec2<S> warp_stage1(const vec2<S>& p, S x, S y) const;
+        template <bool hybrid> vec2<S> warp_stage2(const vec2<S>& v) const;
+        template <bool hybrid> vec2<S> warp_stage3(const vec2<S>& v) const;
+        vec2<S> warp_stage_2d(const vec2<S>& v, typename S::F offset_a, typename S::F offset_b) const;
+        template <bool hybrid> ColourRGBA<S> colour_stage(const vec2<S>& v5, const vec2<S>& v6, const vec2<S>& v7) const;
 
 };
 
@@ -109,88 +311,497 @@ template <SimdFloat S>
 void Renderer<S>::set_size(int w, int h) noexcept {
     this->width = w;
     this->height = h;
-    this->width_f = static_cast<typename S::F>(w);
-    this->height_f = static_cast<typename S::F>(h);
-    if (height==0) return;
-    this->aspect = width_f/height_f;
+    build_plan();
 }
 
 
+/**************************************************************************************************
+ * Calculate the per-frame constants from the size, parameters & seed.
+ * (Called whenever the size or parameters change, and on seed change when using noise slices or the warp grid)
+ * ************************************************************************************************/
+template <SimdFloat S>
+void Renderer<S>::build_plan() {
+    using F = typename S::F;
+
+    plan.valid = width > 0 && height > 0;
+    plan.input_transform = build_input_transform_plan<S>(params);
 
+    auto parameter_scale = static_cast<F>(params.get_value(ParameterID::scale));
+    const auto parameter_directional_bias = static_cast<F>(params.get_value(ParameterID::directional_bias));
+    const auto parameter_evolve1 = 0.1f * static_cast<F>(params.get_value(ParameterID::evolve1));
+    const auto parameter_evolve2 = static_cast<F>(2.0 * std::numbers::pi) * static_cast<F>(params.get_value(ParameterID::evolve2));
+    if (parameter_scale <= 0.0f) parameter_scale = 0.000001f;
+
+    //Pixel co-ordinates to noise space.
+    //Normalised to: Height = -1..1  Width = proportional zero centered.  Then the input transform, directional bias & scale.
+    const double h = std::max(height, 1);
+    const auto normalise = affine2<double>(2.0 / h, 0.0, -width / h, 0.0, 2.0 / h, -1.0);
+    vec2<double> d{1.0, 1.0};
+    if (signbit(parameter_directional_bias)) d.x -= parameter_directional_bias; else d.y += parameter_directional_bias;
+    d = normalize(d) * std::sqrt(2.0) * static_cast<double>(parameter_scale);
+    const auto bias_scale = affine2<double>::scale(d.x, d.y);
+    const auto to_transform = plan.input_transform.pre_transform * normalise;
+    plan.pixel_to_noise = (bias_scale * to_transform).template to<S>();
+    plan.pixel_to_transform = to_transform.template to<S>();
+    plan.noise_scale = vec2<S>(S(static_cast<F>(d.x)), S(static_cast<F>(d.y)));
+
+    //Evolve
+    plan.evolve_x = S(parameter_evolve1 * cos(parameter_evolve2));
+    plan.evolve_y = S(parameter_evolve1 * sin(parameter_evolve2));
+    plan.evolve_x_stage2 = plan.evolve_x + 99.2;
+    plan.evolve_y_stage2 = plan.evolve_y - 99.2;
+    plan.red_z = plan.evolve_x * 0.3f;
+    plan.red_w = plan.evolve_y * 0.3f;
+    plan.green_z = plan.evolve_x * 0.25f;
+    plan.green_w = plan.evolve_y * 0.3f;
+    plan.blue_z = plan.evolve_x * 0.19f;
+    plan.blue_w = plan.evolve_y * 0.3f;
+
+    //Level of detail.  Size of one pixel in noise space.
+    //(Approximate: ignores the local stretch of non-linear input transforms and of the domain warps)
+    const double bias_x = signbit(parameter_directional_bias) ? 1.0 - parameter_directional_bias : 1.0;
+    const double bias_y = signbit(parameter_directional_bias) ? 1.0 : 1.0 + parameter_directional_bias;
+    const double bias = std::max(std::abs(bias_x), std::abs(bias_y)) / std::sqrt(bias_x * bias_x + bias_y * bias_y);
+    const double transform_scale = std::abs(params.get_value(ParameterID::input_transform_scale));
+    const double footprint = (height > 0) ? 2.0 / height * transform_scale * std::sqrt(2.0) * bias * parameter_scale : 0.0;
+
+    plan.footprint = footprint;
+
+    //Only the colour stage is band-limited.  The warps stretch noise space (the first by up to 5x) so the footprint
+    //doesn't hold at their inputs, and a dropped warp octave moves the whole pattern rather than removing fine detail.
+    plan.detail_warp_coarse = make_fbm_detail<8, S>(0.05, 0.0);
+    plan.detail_warp = make_fbm_detail<4, S>(1.0, 0.0);
+    if constexpr (project_uses_band_limited_fbm) plan.detail_colour = make_fbm_detail<8, S>(1.0, footprint);
+    else plan.detail_colour = make_fbm_detail<8, S>(1.0, 0.0);
+
+    //Cache the lattice of first warp octaves with cells at least 32 packets wide, so nearly all packets are in a single cell.
+    plan.cached_octaves_warp_coarse = 0;
+    if constexpr (project_uses_lattice_cache) {
+        const double min_cell_pixels = 32.0 * S::number_of_elements();
+        while (plan.cached_octaves_warp_coarse < 8 && 0.05 * std::exp2(plan.cached_octaves_warp_coarse) * footprint * min_cell_pixels <= 1.0) {
+            plan.cached_octaves_warp_coarse++;
+        }
+    }
+
+    //Hybrid precision z/w, if the finest octave of any evolve offset is too large for float32.  (Same z/w as the float path, in double)
+    plan.hybrid_lattice = false;
+    if constexpr (hybrid_lattice_supported) {
+        const double e1 = 0.1 * params.get_value(ParameterID::evolve1);
+        const double e2 = 2.0 * std::numbers::pi * params.get_value(ParameterID::evolve2);
+        const double ex = e1 * std::cos(e2);
+        const double ey = e1 * std::sin(e2);
+        const double ex2 = ex + 99.2;
+        const double ey2 = ey - 99.2;
+        const std::array<std::array<double, 2>, 2> warp_coarse{ { {ex * 0.05, ey * 0.05}, {ex * 0.05 + 10.0, ey * 0.05 + 10.0} } };
+        const std::array<std::array<double, 2>, 2> warp2{ { {ex2 + 55.0, ey2 + 55.0}, {ex2 + 79.0, ey2 + 79.0} } };
+        const std::array<std::array<double, 2>, 2> warp3{ { {ex - 44.2 + 25.0, ey + 44.2 + 25.0}, {ex - 44.2 + 19.0, ey + 44.2 + 19.0} } };
+        const std::array<std::array<double, 2>, 3> colour{ { {ex * 0.3, ey * 0.3}, {ex * 0.25, ey * 0.3}, {ex * 0.19, ey * 0.3} } };
+
+        double largest = 0.0;
+        const auto split = [&largest](auto& out, const auto& in, int octaves) {
+            for (size_t n = 0; n < in.size(); n++) {
+                for (size_t axis = 0; axis < 2; axis++) {
+                    out[n][axis] = LatticeCoordinate<S>::from_double(in[n][axis]);
+                    largest = std::max(largest, std::abs(in[n][axis]) * std::exp2(std::max(octaves - 1, 0)));
+                }
+            }
+        };
+        split(plan.hybrid_warp_coarse, warp_coarse, plan.detail_warp_coarse.octaves);
+        split(plan.hybrid_warp2, warp2, plan.detail_warp.octaves);
+        split(plan.hybrid_warp3, warp3, plan.detail_warp.octaves);
+        split(plan.hybrid_colour, colour, plan.detail_colour.octaves);
+        plan.hybrid_lattice = largest > project_hybrid_lattice_limit;
+    }
+
+    //Evolve slices.  (Same z/w as the 4D inputs in render_pixel)
+    if constexpr (project_uses_noise_slices) {
+        const auto ex = static_cast<F>(parameter_evolve1 * cos(parameter_evolve2));
+        const auto ey = static_cast<F>(parameter_evolve1 * sin(parameter_evolve2));
+        const F ex2 = ex + static_cast<F>(99.2);
+        const F ey2 = ey - static_cast<F>(99.2);
+        plan.slices_warp_coarse = { make_fbm_slices<8, lattice>(ex * 0.05f, ey * 0.05f, seed), make_fbm_slices<8, lattice>(ex * 0.05f + 10.0f, ey * 0.05f + 10.0f, seed) };
+        plan.slices_warp = { make_fbm_slices<4, lattice>(ex2 + 55.0f, ey2 + 55.0f, seed), make_fbm_slices<4, lattice>(ex2 + 79.0f, ey2 + 79.0f, seed) };
+        plan.slices_colour = { make_fbm_slices<8, lattice>(ex * 0.3f, ey * 0.3f, seed), make_fbm_slices<8, lattice>(ex * 0.25f, ey * 0.3f, seed), make_fbm_slices<8, lattice>(ex * 0.19f, ey * 0.3f, seed) };
+    }
+
+    //The warp grid is rebuilt on first use.  (Fresh objects, so renderers sharing the old grid keep it)
+    if constexpr (project_uses_warp_grid) {
+        warp_grid = std::make_shared<CoarseGrid>();
+        warp_grid_once = std::make_shared<std::once_flag>();
+    }
+
+    build_position_tables();
+    select_render_kernels<project_uses_render_variants>();
+}
 
 
 /**************************************************************************************************
- * Render a pixel (or batch of pixels if using SIMD)
- * 
+ * Select the render kernels for the frame.
+ * variants = false: always the generic <true, true> kernel, which checks the input transform & hybrid lattice at run time.
+ * variants = true: kernels with the checks compiled out for frames that don't need them.  (4x the kernels to compile)
+ * All kernels render the same output.
  * ************************************************************************************************/
 template <SimdFloat S>
-ColourRGBA<S> Renderer<S>::render_pixel(S x, S y) const {
-    if (width <=0 || height <=0) return ColourRGBA<S>{};
-    next_random<typename S::F>(seed); //Reset random seed so it is the same for each pixel
-    
-    auto parameter_scale = static_cast<typename S::F>(params.get_value(ParameterID::scale));
-    const auto parameter_directional_bias = static_cast<typename S::F>(params.get_value(ParameterID::directional_bias));
-    const auto parameter_evolve1 = 0.1f * static_cast<typename S::F>(params.get_value(ParameterID::evolve1));
-    const auto parameter_evolve2 = static_cast<typename S::F>(2.0* std::numbers::pi) * static_cast<typename S::F>(params.get_value(ParameterID::evolve2));
-    
-    if (parameter_scale <= 0.0f) parameter_scale = 0.000001f;
+template <bool variants>
+void Renderer<S>::select_render_kernels() {
+    if constexpr (variants) {
+        constexpr std::array<PixelKernel, 4> pixel_kernels{
+            &Renderer::render_pixel_kernel<false, false>,
+            &Renderer::render_pixel_kernel<true, false>,
+            &Renderer::render_pixel_kernel<false, true>,
+            &Renderer::render_pixel_kernel<true, true>,
+        };
+        constexpr std::array<PositionKernel, 4> position_kernels{
+            &Renderer::render_position_kernel<false, false>,
+            &Renderer::render_position_kernel<true, false>,
+            &Renderer::render_position_kernel<false, true>,
+            &Renderer::render_position_kernel<true, true>,
+        };
+        constexpr std::array<TileKernel, 4> tile_kernels{
+            &Renderer::render_tile_kernel<false, false>,
+            &Renderer::render_tile_kernel<true, false>,
+            &Renderer::render_tile_kernel<false, true>,
+            &Renderer::render_tile_kernel<true, true>,
+        };
+        const int i = (plan.input_transform.affine ? 0 : 1) | (plan.hybrid_lattice ? 2 : 0);
+        pixel_kernel = pixel_kernels[i];
+        position_kernel = position_kernels[i];
+        tile_kernel = tile_kernels[i];
+    }
+    else {
+        pixel_kernel = &Renderer::render_pixel_kernel<true, true>;
+        position_kernel = &Renderer::render_position_kernel<true, true>;
+        tile_kernel = &Renderer::render_tile_kernel<true, true>;
+    }
+}
 
-    S xf = x ;
-    S yf = y ;
 
+/**************************************************************************************************
+ * Build the position tables for separable special transforms.  (See InputTransformPlan::column_x)
+ * The position of a packet is then two (or for "Wave" three) loads instead of the input transform,
+ * so "Wave" calls sin once per column rather than once per packet.  Same rounding as pixel_position.
+ * ("None" is a single matrix in pixel_position, so it needs no tables)
+ * ************************************************************************************************/
+template <SimdFloat S>
+void Renderer<S>::build_position_tables() {
+    using P = RenderPacket<S>;
+    plan.position_x.clear();
+    plan.position_y.clear();
+    plan.position_y_offset.clear();
+    if (!project_uses_position_tables || !plan.valid || !plan.input_transform.separable || plan.input_transform.affine) return;
+
+    const auto& transform = plan.input_transform;
+    const bool y_offset = transform.transform == InputTransform::wave;
+    plan.position_x.resize(width);
+    plan.position_y.resize(height);
+    if (y_offset) plan.position_y_offset.resize(width);
+
+    for (int i = 0; i < width; i++) {
+        const S x = plan.pixel_to_transform.apply(vec2<S>(P::x(i), P::y(0))).x;
+        plan.position_x[i] = transform.column_x(x) * plan.noise_scale.x;
+        if (y_offset) plan.position_y_offset[i] = transform.column_y(x);
+    }
+    for (int i = 0; i < height; i++) {
+        const S y = transform.row_y(plan.pixel_to_transform.apply(vec2<S>(P::x(0), P::y(i))).y);
+        plan.position_y[i] = y_offset ? y : y * plan.noise_scale.y;
+    }
+}
 
-    //Normalise to range: Hight = -1..1  Width = proportional zero centered.
-    vec2<S> p(aspect * (static_cast<typename S::F>(2.0) * xf / width_f - static_cast<typename S::F>(1.0)), static_cast<typename S::F>(2.0) * yf / height_f - static_cast<typename S::F>(1.0));
- 
-    //Apply Input Transforms
-    p = perform_input_transform(params.get_string(ParameterID::input_transform_type),p, params);
 
-    
-    //Apply Directional Bias
-    vec2<S> d{1.0,1.0};
-    if (signbit(parameter_directional_bias)) d.x -= parameter_directional_bias; else d.y += parameter_directional_bias;
-    p = p * normalize(d) * static_cast<typename S::F>(sqrt(2)) * parameter_scale;
-    
-    auto evolve_x = S(parameter_evolve1 * cos(parameter_evolve2));
-    auto evolve_y = S(parameter_evolve1 * sin(parameter_evolve2));
-    
-    
-    auto p3 = vec4(p, evolve_x, evolve_y);
-    
 
 
-    auto nVec2 = p + (vec2(fbm(p3*0.05, 8, seed), fbm(p3*0.05 + 10.0f, 8, seed)) - 0.5f)*5.0f;
-    
+
+/**************************************************************************************************
+ * The lattice table of the 2D noise stages for the current seed, or nullptr to hash.
+ * Found (or built) on first use, so only the seed that is rendered gets a table.  (Hosts may set a placeholder seed first)
+ * Tables are shared by the whole process, so this is only slow the first time a seed is used.
+ * ************************************************************************************************/
+template <SimdFloat S>
+const LatticeTable* Renderer<S>::find_lattice_table() const {
+    //(AVX-512 hashes 16 lanes as fast as it can gather them, so only narrower types use the table.
+    // Not the scalar type: it is the WASM worker renderer, and a 16MB table doesn't fit the default 16MB Emscripten heap)
+    if constexpr (project_uses_lattice_table && SimdFloat32<S> && S::number_of_elements() > 1 && S::number_of_elements() < 16) {
+        std::call_once(lattice_table->once, [this] { lattice_table->table = LatticeTable::shared<lattice>(seed); });
+        return lattice_table->table.get();
+    }
+    else {
+        return nullptr;
+    }
+}
 
 
 
-    p3 = vec4(nVec2, evolve_x + 99.2 , evolve_y-99.2);    
-    auto nVec3 = nVec2 + vec2(fbm(p3 + 55.0f, 4, seed), fbm(p3 + 79.0f, 4, seed)) - 0.5f;
 
-    p3 = vec4(nVec3, nVec3.x+ evolve_x - 44.2, nVec3.y+evolve_y + 44.2);
-    auto nVec4 = nVec3 + vec2(fbm(p3 + 25.0f, 4, seed), fbm(p3 + 19.0f, 4, seed)) - 0.5f;
 
+/**************************************************************************************************
+ * Pixel co-ordinates to noise space.  (Normalise, input transform & directional bias)
+ * The affine steps are folded into per-frame matrices, so "None" is 4 FMAs
+ * and the other transforms are 4 FMAs, the special transform & 2 multiplies.
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool transform>
+vec2<S> Renderer<S>::pixel_position(S xf, S yf) const {
+    const vec2<S> p{xf, yf};
+    if constexpr (transform) {
+        if (!plan.input_transform.affine) return plan.input_transform.apply_special(plan.pixel_to_transform.apply(p)) * plan.noise_scale;
+    }
+    return plan.pixel_to_noise.apply(p);
+}
+
+
+/**************************************************************************************************
+ * Noise space position of the packet with top left pixel (x, y) from the position tables.
+ * Returns false if there are no tables, or the packet is outside the image.
+ * ************************************************************************************************/
+template <SimdFloat S>
+bool Renderer<S>::table_position(int x, int y, vec2<S>& p) const {
+    if (x < 0 || y < 0 || x >= static_cast<int>(plan.position_x.size()) || y >= static_cast<int>(plan.position_y.size())) return false;
+    if (plan.position_y_offset.empty()) p = vec2<S>(plan.position_x[x], plan.position_y[y]);
+    else p = vec2<S>(plan.position_x[x], (plan.position_y[y] + plan.position_y_offset[x]) * plan.noise_scale.y);
+    return true;
+}
+
+
+/**************************************************************************************************
+ * The first (low frequency) warp at noise space position p.  Returns n1 & n2 (0..1)
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool hybrid>
+vec2<S> Renderer<S>::warp_coarse(const vec2<S>& p) const {
+    static_assert(!(project_uses_noise_slices && project_uses_simplex_noise), "Noise slices are value noise only");
+    if constexpr (hybrid_lattice_supported && hybrid) {
+        if (plan.hybrid_lattice) {
+            const auto& zw = plan.hybrid_warp_coarse;
+            const auto [n1, n2] = fbm_multi<2, 8, lattice, basis>(std::array{ HybridVec4<S>{p * 0.05, zw[0][0], zw[0][1]}, HybridVec4<S>{p * 0.05 + 10.0f, zw[1][0], zw[1][1]} }, plan.detail_warp_coarse, seed, &thread_lattice_cache(), plan.cached_octaves_warp_coarse);
+            return vec2(n1, n2);
+        }
+    }
+    const auto p3 = vec4(p, plan.evolve_x, plan.evolve_y);
+    const auto [n1, n2] = [&] {
+        if constexpr (project_uses_noise_slices) return fbm_multi_slice<2, 8, lattice>(std::array{p * 0.05, p * 0.05 + 10.0f}, plan.slices_warp_coarse, plan.detail_warp_coarse, seed);
+        else return fbm_multi<2, 8, lattice, basis>(std::array{p3 * 0.05, p3 * 0.05 + 10.0f}, plan.detail_warp_coarse, seed, thread_lattice_cache(), plan.cached_octaves_warp_coarse);
+    }();
+    return vec2(n1, n2);
+}
+
+
+/**************************************************************************************************
+ * Sample the first warp on a coarse grid of pixels.
+ * Built on first use by render_pixel (once per plan, other threads wait), as the warp depends on
+ * the size, parameters & seed.  Each tile is checked against the exact warp at 9 points (corners,
+ * edge midpoints & centre), and tiles that interpolate worse than project_warp_grid_max_error pixels
+ * at any of them are rendered exactly.  (See CoarseGrid in coarse-grid.h)
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool transform, bool hybrid>
+void Renderer<S>::build_warp_grid() const {
+    //The warp is scaled by 5 before use, and plan.footprint is the size of a pixel in noise space.
+    const double max_error = project_warp_grid_max_error * plan.footprint / 5.0;
+    warp_grid->template build<S>(width, height, project_warp_grid_step, max_error, [this](S px, S py) { return warp_coarse<hybrid>(pixel_position<transform>(px, py)); });
+}
 
-    auto nVec5 = nVec4 + vec2(fbm(nVec4 - 12.0f, 4, seed), fbm(nVec4 - 19.0f, 4, seed)) - 0.5f;
-    auto nVec6 = nVec5 + vec2(fbm(nVec5 - 35.0f, 4, seed), fbm(nVec5 + 99.0f, 4, seed)) - 0.5f;
-    auto nVec7 = nVec6 + vec2(fbm(nVec6 - 88.0f, 4, seed), fbm(nVec6 - 1.0f, 4, seed)) - 0.5f;
-    
-    auto r = fbm(vec4(nVec5, evolve_x*0.3f, evolve_y * 0.3f), 8,seed) * 0.65f;
-    auto g = fbm(vec4(nVec6, evolve_x*0.25f, evolve_y * 0.3f), 8, seed) * 0.65f;
-    auto b = fbm(vec4(nVec7, evolve_x*0.19f, evolve_y * 0.3f), 8, seed) * 0.65f;
-    
 
-    
-    return ColourRGBA{r,g,b}; 
 
 
 
+/**************************************************************************************************
+ * Stage 1: the first warp.  (Interpolated from a coarse grid where it is close enough, see build_warp_grid)
+ * x & y are the pixel co-ordinates of p.
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool transform, bool hybrid>
+vec2<S> Renderer<S>::warp_stage1(const vec2<S>& p, S x, S y) const {
+    vec2<S> n;
+    if constexpr (project_uses_warp_grid) {
+        std::call_once(*warp_grid_once, [this] { build_warp_grid<transform, hybrid>(); });
+        if (!warp_grid->sample(x, y, n)) n = warp_coarse<hybrid>(p);
+    }
+    else {
+        n = warp_coarse<hybrid>(p);
+    }
+    return p + (n - 0.5f) * 5.0f;
+}
+
 
+/**************************************************************************************************
+ * Stage 2: 4D warp with evolve z/w.
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool hybrid>
+vec2<S> Renderer<S>::warp_stage2(const vec2<S>& v) const {
+    if constexpr (hybrid_lattice_supported && hybrid) {
+        if (plan.hybrid_lattice) {
+            const auto& zw = plan.hybrid_warp2;
+            const auto [n3, n4] = fbm_multi<2, 4, lattice, basis>(std::array{ HybridVec4<S>{v + 55.0f, zw[0][0], zw[0][1]}, HybridVec4<S>{v + 79.0f, zw[1][0], zw[1][1]} }, plan.detail_warp, seed);
+            return v + vec2(n3, n4) - 0.5f;
+        }
+    }
+    const auto p3 = vec4(v, plan.evolve_x_stage2, plan.evolve_y_stage2);
+    const auto [n3, n4] = [&] {
+        if constexpr (project_uses_noise_slices) return fbm_multi_slice<2, 4, lattice>(std::array{v + 55.0f, v + 79.0f}, plan.slices_warp, plan.detail_warp, seed);
+        else return fbm_multi<2, 4, lattice, basis>(std::array{p3 + 55.0f, p3 + 79.0f}, plan.detail_warp, seed);
+    }();
+    return v + vec2(n3, n4) - 0.5f;
+}
 
-  
 
+/**************************************************************************************************
+ * Stage 3: 4D warp.  (z/w depend on the pixel, so this stage is always 4D)
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool hybrid>
+vec2<S> Renderer<S>::warp_stage3(const vec2<S>& v) const {
+    if constexpr (hybrid_lattice_supported && hybrid) {
+        if (plan.hybrid_lattice) {
+            const auto& zw = plan.hybrid_warp3;
+            const auto [n5, n6] = fbm_multi<2, 4, lattice, basis>(std::array{ HybridVec4<S>{v + 25.0f, zw[0][0] + v.x, zw[0][1] + v.y}, HybridVec4<S>{v + 19.0f, zw[1][0] + v.x, zw[1][1] + v.y} }, plan.detail_warp, seed);
+            return v + vec2(n5, n6) - 0.5f;
+        }
+    }
+    const auto p3 = vec4(v, v.x + plan.evolve_x - 44.2, v.y + plan.evolve_y + 44.2);
+    const auto [n5, n6] = fbm_multi<2, 4, lattice, basis>(std::array{p3 + 25.0f, p3 + 19.0f}, plan.detail_warp, seed);
+    return v + vec2(n5, n6) - 0.5f;
+}
+
+
+/**************************************************************************************************
+ * Stages 4 to 6: 2D warps.  (The offsets select the noise for each stage)
+ * ************************************************************************************************/
+template <SimdFloat S>
+vec2<S> Renderer<S>::warp_stage_2d(const vec2<S>& v, typename S::F offset_a, typename S::F offset_b) const {
+    const auto [na, nb] = fbm_multi<2, 4, lattice, basis>(std::array{v + offset_a, v + offset_b}, plan.detail_warp, seed, find_lattice_table());
+    return v + vec2(na, nb) - 0.5f;
+}
+
+
+/**************************************************************************************************
+ * Stage 7: colour from the last three warps.
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool hybrid>
+ColourRGBA<S> Renderer<S>::colour_stage(const vec2<S>& v5, const vec2<S>& v6, const vec2<S>& v7) const {
+    const auto rgb = [&] {
+        if constexpr (hybrid_lattice_supported && hybrid) {
+            if (plan.hybrid_lattice) {
+                const auto& zw = plan.hybrid_colour;
+                return fbm_multi<3, 8, lattice, basis>(std::array{ HybridVec4<S>{v5, zw[0][0], zw[0][1]}, HybridVec4<S>{v6, zw[1][0], zw[1][1]}, HybridVec4<S>{v7, zw[2][0], zw[2][1]} }, plan.detail_colour, seed);
+            }
+        }
+        if constexpr (project_uses_noise_slices) return fbm_multi_slice<3, 8, lattice>(std::array{v5, v6, v7}, plan.slices_colour, plan.detail_colour, seed);
+        else return fbm_multi<3, 8, lattice, basis>(std::array{vec4(v5, plan.red_z, plan.red_w), vec4(v6, plan.green_z, plan.green_w), vec4(v7, plan.blue_z, plan.blue_w)}, plan.detail_colour, seed);
+    }();
+    auto r = rgb[0] * 0.65f;
+    auto g = rgb[1] * 0.65f;
+    auto b = rgb[2] * 0.65f;
+    return ColourRGBA{ r,g,b };
+}
+
+
+
+
+
+/**************************************************************************************************
+ * Render a pixel (or batch of pixels if using SIMD)
+ * 
+ * ************************************************************************************************/
+template <SimdFloat S>
+ColourRGBA<S> Renderer<S>::render_pixel(S x, S y) const {
+    if (!plan.valid) return ColourRGBA<S>{};
+    return (this->*pixel_kernel)(x, y);
+}
+
+//The position tables are in RenderPacket<S> layout, so other layouts (eg. the scan lines at the edge of an image) calculate the position.
+template <SimdFloat S>
+template <typename P>
+ColourRGBA<S> Renderer<S>::render_packet(int x, int y) const {
+    if (!plan.valid) return ColourRGBA<S>{};
+    const S px = P::x(x);
+    const S py = P::y(y);
+    if constexpr (std::is_same_v<P, RenderPacket<S>>) {
+        vec2<S> p;
+        if (table_position(x, y, p)) return (this->*position_kernel)(p, px, py);
+    }
+    return (this->*pixel_kernel)(px, py);
+}
+
+template <SimdFloat S>
+template <bool transform, bool hybrid>
+ColourRGBA<S> Renderer<S>::render_pixel_kernel(S x, S y) const {
+    return render_position_kernel<transform, hybrid>(pixel_position<transform>(x, y), x, y);
+}
+
+//p is the noise space position of pixels (x, y)
+template <SimdFloat S>
+template <bool transform, bool hybrid>
+ColourRGBA<S> Renderer<S>::render_position_kernel(const vec2<S>& p, S x, S y) const {
+    const auto nVec2 = warp_stage1<transform, hybrid>(p, x, y);
+    const auto nVec3 = warp_stage2<hybrid>(nVec2);
+    const auto nVec4 = warp_stage3<hybrid>(nVec3);
+    const auto nVec5 = warp_stage_2d(nVec4, -12.0f, -19.0f);
+    const auto nVec6 = warp_stage_2d(nVec5, -35.0f, 99.0f);
+    const auto nVec7 = warp_stage_2d(nVec6, -88.0f, -1.0f);
+    return colour_stage<hybrid>(nVec5, nVec6, nVec7);
 }    
 
+
+/**************************************************************************************************
+ * Render a tile of packets one stage at a time.  (Same results as render_pixel for each packet)
+ * Each stage is a tight loop over the whole tile, so only one stage's code & tables are in use at a time.
+ * If times is given, the time spent in each stage is added to it.
+ * ************************************************************************************************/
+template <SimdFloat S>
+template <bool transform, bool hybrid>
+void Renderer<S>::render_tile_kernel(RenderTile<S>& tile, RenderStageTimes* times) const {
+    const size_t n = tile.size();
+    if constexpr (project_uses_warp_grid) std::call_once(*warp_grid_once, [this] { build_warp_grid<transform, hybrid>(); });
+
+    int stage = 0;
+    const auto run_stage = [&](auto&& body) {
+        if (!times) [[likely]] {
+            for (size_t i = 0; i < n; i++) body(i);
+        }
+        else {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < n; i++) body(i);
+            times->seconds[stage] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        stage++;
+    };
+
+    run_stage([&](size_t i) {
+        tile.x[i] = RenderPacket<S>::x(tile.packet_x[i]);
+        tile.y[i] = RenderPacket<S>::y(tile.packet_y[i]);
+        if (!table_position(tile.packet_x[i], tile.packet_y[i], tile.warp[i])) tile.warp[i] = pixel_position<transform>(tile.x[i], tile.y[i]);
+    });
+    run_stage([&](size_t i) { tile.warp[i] = warp_stage1<transform, hybrid>(tile.warp[i], tile.x[i], tile.y[i]); });
+    run_stage([&](size_t i) { tile.warp[i] = warp_stage2<hybrid>(tile.warp[i]); });
+    run_stage([&](size_t i) { tile.warp[i] = warp_stage3<hybrid>(tile.warp[i]); });
+    if constexpr (RenderTile<S>::half) {
+        //Each warp stays in float for the next stage, & is stored as the offset to it.
+        run_stage([&](size_t i) { tile.warp[i] = warp_stage_2d(tile.warp[i], -12.0f, -19.0f); });
+        run_stage([&](size_t i) {
+            const auto v6 = warp_stage_2d(tile.warp[i], -35.0f, 99.0f);
+            tile.warp5[i] = HalfVec2<S>(tile.warp[i] - v6);
+            tile.warp[i] = v6;
+        });
+        run_stage([&](size_t i) {
+            const auto v7 = warp_stage_2d(tile.warp[i], -88.0f, -1.0f);
+            tile.warp6[i] = HalfVec2<S>(tile.warp[i] - v7);
+            tile.warp[i] = v7;
+        });
+        run_stage([&](size_t i) {
+            const auto v6 = tile.warp[i] + tile.warp6[i].load();
+            tile.colour[i] = colour_stage<hybrid>(v6 + tile.warp5[i].load(), v6, tile.warp[i]);
+        });
+    }
+    else {
+        run_stage([&](size_t i) { tile.warp5[i] = warp_stage_2d(tile.warp[i], -12.0f, -19.0f); });
+        run_stage([&](size_t i) { tile.warp6[i] = warp_stage_2d(tile.warp5[i], -35.0f, 99.0f); });
+        run_stage([&](size_t i) { tile.warp[i] = warp_stage_2d(tile.warp6[i], -88.0f, -1.0f); });
+        run_stage([&](size_t i) { tile.colour[i] = colour_stage<hybrid>(tile.warp5[i], tile.warp6[i], tile.warp[i]); });
+    }
+}
+
 /**************************************************************************************************
  * Render a pixel (or batch of pixels if using SIMD)
  * an input pixel is given